@@ -246,9 +246,11 @@ public:
   /// example, if you pass in 3 here, you will get an 8 byte alignment. If a
   /// global value is specified, and if that global has an explicit alignment
   /// requested, it will override the alignment request if required for
-  /// correctness.
+  /// correctness. If MaxBytesToEmit is non-zero, the alignment is skipped when
+  /// it would take more padding than that.
   ///
-  void EmitAlignment(unsigned NumBits, const GlobalObject *GO = nullptr) const;
+  void EmitAlignment(unsigned NumBits, const GlobalObject *GO = nullptr,
+                     unsigned MaxBytesToEmit = 0) const;
 
   /// Lower the specified LLVM Constant to an MCExpr.
   const MCExpr *lowerConstant(const Constant *CV);
@@ -523,6 +523,29 @@ public:
     return Cost;
   }
 
+  /// Without native support a gather or scatter is expanded into one scalar
+  /// memory operation per lane, plus the cost of extracting the addresses and
+  /// building (or decomposing) the data vector. A variable mask adds an
+  /// extract and a branch per lane.
+  unsigned getGatherScatterOpCost(unsigned Opcode, Type *DataTy, Value *Ptr,
+                                  bool VariableMask, unsigned Alignment) {
+    assert(DataTy->isVectorTy() && "Gather/scatter of a scalar type");
+    unsigned VF = DataTy->getVectorNumElements();
+    Type *EltTy = DataTy->getVectorElementType();
+    unsigned MemOpCost = static_cast<T *>(this)->getMemoryOpCost(
+        Opcode, EltTy, Alignment, 0);
+    unsigned Cost = VF * MemOpCost +
+                    getScalarizationOverhead(DataTy, Opcode == Instruction::Load,
+                                             Opcode == Instruction::Store);
+    if (Ptr && Ptr->getType()->isVectorTy())
+      Cost += getScalarizationOverhead(Ptr->getType(), false, true);
+    else
+      Cost += VF;
+    if (VariableMask)
+      Cost += 2 * VF;
+    return Cost;
+  }
+
   unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
                                       unsigned Factor,
                                       ArrayRef<unsigned> Indices,
@@ -697,6 +720,13 @@ public:
     case Intrinsic::masked_load:
       return static_cast<T *>(this)
           ->getMaskedMemoryOpCost(Instruction::Load, RetTy, 0, 0);
+    case Intrinsic::masked_scatter:
+      return static_cast<T *>(this)
+          ->getGatherScatterOpCost(Instruction::Store, Tys[0], nullptr,
+                                   true, 0);
+    case Intrinsic::masked_gather:
+      return static_cast<T *>(this)
+          ->getGatherScatterOpCost(Instruction::Load, RetTy, nullptr, true, 0);
     }
 
     const TargetLoweringBase *TLI = getTLI();
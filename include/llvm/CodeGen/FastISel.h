@@ -537,6 +537,9 @@ protected:
   bool selectPatchpoint(const CallInst *I);
   bool selectCall(const User *Call);
   bool selectIntrinsicCall(const IntrinsicInst *II);
+  /// \brief Select an intrinsic whose first argument and result map directly
+  /// onto the given unary ISD opcode.
+  bool selectUnaryIntrinsic(const IntrinsicInst *II, unsigned ISDOpcode);
   bool selectBitCast(const User *I);
   bool selectCast(const User *I, unsigned Opcode);
   bool selectExtractValue(const User *I);
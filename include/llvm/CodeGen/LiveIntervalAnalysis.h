@@ -28,6 +28,7 @@
 #include "llvm/CodeGen/SlotIndexes.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Recycler.h"
 #include "llvm/Target/TargetRegisterInfo.h"
 #include <cmath>
 #include <iterator>
@@ -64,6 +65,13 @@ extern cl::opt<bool> UseSegmentSetForPhysRegs;
     ///
     VNInfo::Allocator VNInfoAllocator;
 
+    /// Storage for the LiveInterval objects. Intervals are created and deleted
+    /// constantly during register allocation, so they are carved out of a bump
+    /// allocator and freed intervals are recycled instead of going through
+    /// malloc for each one.
+    BumpPtrAllocator IntervalAllocator;
+    Recycler<LiveInterval> IntervalRecycler;
+
     /// Live interval pointers for all the virtual registers.
     IndexedMap<LiveInterval*, VirtReg2IndexFunctor> VirtRegIntervals;
 
@@ -138,7 +146,7 @@ extern cl::opt<bool> UseSegmentSetForPhysRegs;
 
     // Interval removal.
     void removeInterval(unsigned Reg) {
-      delete VirtRegIntervals[Reg];
+      destroyInterval(VirtRegIntervals[Reg]);
       VirtRegIntervals[Reg] = nullptr;
     }
 
@@ -423,7 +431,8 @@ extern cl::opt<bool> UseSegmentSetForPhysRegs;
     bool computeDeadValues(LiveInterval &LI,
                            SmallVectorImpl<MachineInstr*> *dead);
 
-    static LiveInterval* createInterval(unsigned Reg);
+    LiveInterval* createInterval(unsigned Reg);
+    void destroyInterval(LiveInterval *LI);
 
     void printInstrs(raw_ostream &O) const;
     void dumpInstrs() const;
@@ -87,6 +87,12 @@ class MachineBasicBlock : public ilist_node<MachineBasicBlock> {
   /// The alignment is specified as log2(bytes).
   unsigned Alignment;
 
+  /// PaddedAlignment - Additional alignment the block should get if it takes
+  /// at most PaddedAlignmentMaxBytes bytes of padding, as log2(bytes). Zero if
+  /// none.
+  unsigned PaddedAlignment;
+  unsigned PaddedAlignmentMaxBytes;
+
   /// IsLandingPad - Indicate that this basic block is entered via an
   /// exception handler.
   bool IsLandingPad;
@@ -358,6 +364,24 @@ public:
   ///
   void setAlignment(unsigned Align) { Alignment = Align; }
 
+  /// Return the alignment the block should get when it is cheap enough, as
+  /// log2(bytes), or zero.
+  unsigned getPaddedAlignment() const { return PaddedAlignment; }
+
+  /// Return the most padding that may be inserted for getPaddedAlignment().
+  unsigned getPaddedAlignmentMaxBytes() const {
+    return PaddedAlignmentMaxBytes;
+  }
+
+  /// Ask for the block to be aligned to 1 << Align bytes if that takes at
+  /// most MaxBytes bytes of padding. The decision is made when the code is
+  /// laid out, so targets whose passes compute block offsets must not use
+  /// this. The block is still aligned to getAlignment() in any case.
+  void setPaddedAlignment(unsigned Align, unsigned MaxBytes) {
+    PaddedAlignment = Align;
+    PaddedAlignmentMaxBytes = MaxBytes;
+  }
+
   /// isLandingPad - Returns true if the block is a landing pad. That is
   /// this basic block is entered via an exception handler.
   bool isLandingPad() const { return IsLandingPad; }
@@ -947,6 +947,10 @@ protected:
   void pickNodeFromQueue(SchedCandidate &Cand);
 };
 
+/// Create the standard converging machine scheduler, with the generic DAG
+/// mutations registered. Targets may add their own mutations on top of it.
+ScheduleDAGMILive *createGenericSchedLive(MachineSchedContext *C);
+
 } // namespace llvm
 
 #endif
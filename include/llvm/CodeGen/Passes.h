@@ -530,6 +530,10 @@ namespace llvm {
   /// information.
   extern char &MachineBlockPlacementStatsID;
 
+  /// HotBlockAlignment - This pass aligns hot loops and branch targets to the
+  /// target's instruction fetch window, within a code-size budget.
+  extern char &HotBlockAlignmentID;
+
   /// GCLowering Pass - Used by gc.root to perform its default lowering
   /// operations.
   FunctionPass *createGCLoweringPass();
@@ -2012,7 +2012,8 @@ public:
   // In the both nodes address is Op1, mask is Op2:
   // MaskedLoadSDNode (Chain, ptr, mask, src0), src0 is a passthru value
   // MaskedStoreSDNode (Chain, ptr, mask, data)
-  // Mask is a vector of i1 elements
+  // Mask is a vector of i1 elements, or of wider integers once the type
+  // legalizer has promoted it on targets without vector predicates.
   const SDValue &getBasePtr() const { return getOperand(1); }
   const SDValue &getMask() const    { return getOperand(2); }
 
@@ -2086,7 +2087,8 @@ public:
   // In the both nodes address is Op1, mask is Op2:
   // MaskedGatherSDNode  (Chain, src0, mask, base, index), src0 is a passthru value
   // MaskedScatterSDNode (Chain, value, mask, base, index)
-  // Mask is a vector of i1 elements
+  // Mask is a vector of i1 elements, or of wider integers once the type
+  // legalizer has promoted it on targets without vector predicates.
   const SDValue &getBasePtr() const { return getOperand(3); }
   const SDValue &getIndex()   const { return getOperand(4); }
   const SDValue &getMask()    const { return getOperand(2); }
@@ -2112,8 +2114,8 @@ public:
     assert(getMask().getValueType().getVectorNumElements() == 
            getValueType(0).getVectorNumElements() && 
            "Vector width mismatch between mask and data");
-    assert(getMask().getValueType().getScalarType() == MVT::i1 && 
-           "Vector width mismatch between mask and data");
+    assert(getMask().getValueType().getScalarType().isInteger() &&
+           "Mask of a gather/scatter must be an integer vector");
   }
 
   static bool classof(const SDNode *N) {
@@ -2134,8 +2136,8 @@ public:
     assert(getMask().getValueType().getVectorNumElements() == 
            getValue().getValueType().getVectorNumElements() && 
            "Vector width mismatch between mask and data");
-    assert(getMask().getValueType().getScalarType() == MVT::i1 && 
-           "Vector width mismatch between mask and data");
+    assert(getMask().getValueType().getScalarType().isInteger() &&
+           "Mask of a gather/scatter must be an integer vector");
   }
 
   static bool classof(const SDNode *N) {
@@ -77,9 +77,18 @@ public:
   }
   void passEnumerate(const PassInfo *P) override { passRegistered(P); }
 
+  // parse - Passes registered on demand only show up in our map once someone
+  // looks for one, so do that before looking the argument up.
+  bool parse(cl::Option &O, StringRef ArgName, StringRef Arg,
+             const PassInfo *&Val) {
+    PassRegistry::getPassRegistry()->runDeferredInitializers();
+    return cl::parser<const PassInfo*>::parse(O, ArgName, Arg, Val);
+  }
+
   // printOptionInfo - Print out information about this option.  Override the
   // default implementation to sort the table before we print...
   void printOptionInfo(const cl::Option &O, size_t GlobalWidth) const override {
+    PassRegistry::getPassRegistry()->runDeferredInitializers();
     PassNameParser *PNP = const_cast<PassNameParser*>(this);
     array_pod_sort(PNP->Values.begin(), PNP->Values.end(), ValLessThan);
     cl::parser<const PassInfo*>::printOptionInfo(O, GlobalWidth);
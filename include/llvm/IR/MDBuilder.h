@@ -63,6 +63,13 @@ public:
   /// Return metadata containing the entry count for a function.
   MDNode *createFunctionEntryCount(uint64_t Count);
 
+  //===------------------------------------------------------------------===//
+  // Unpredictable metadata.
+  //===------------------------------------------------------------------===//
+
+  /// \brief Return metadata marking a branch or select as unpredictable.
+  MDNode *createUnpredictable();
+
   //===------------------------------------------------------------------===//
   // Range metadata.
   //===------------------------------------------------------------------===//
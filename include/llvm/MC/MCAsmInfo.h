@@ -355,6 +355,14 @@ protected:
   /// Compress DWARF debug sections. Defaults to false.
   bool CompressDebugSections;
 
+  /// Use the fastest zlib level when compressing DWARF debug sections.
+  /// Defaults to false.
+  bool CompressDebugSectionsFast;
+
+  /// Number of threads each DWARF debug section is compressed on; 0 means one
+  /// per hardware thread. Defaults to 1.
+  unsigned CompressDebugSectionsThreads;
+
   /// True if the integrated assembler should interpret 'a >> b' constant
   /// expressions as logical rather than arithmetic.
   bool UseLogicalShr;
@@ -553,6 +561,20 @@ public:
     this->CompressDebugSections = CompressDebugSections;
   }
 
+  bool compressDebugSectionsFast() const { return CompressDebugSectionsFast; }
+
+  void setCompressDebugSectionsFast(bool Value) {
+    CompressDebugSectionsFast = Value;
+  }
+
+  unsigned compressDebugSectionsThreads() const {
+    return CompressDebugSectionsThreads;
+  }
+
+  void setCompressDebugSectionsThreads(unsigned Threads) {
+    CompressDebugSectionsThreads = Threads;
+  }
+
   bool shouldUseLogicalShr() const { return UseLogicalShr; }
 };
 }
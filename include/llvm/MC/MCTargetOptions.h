@@ -34,7 +34,12 @@ public:
   bool ShowMCEncoding : 1;
   bool ShowMCInst : 1;
   bool AsmVerbose : 1;
+  /// Trade compression ratio for speed when compressing debug sections.
+  bool CompressDebugSectionsFast : 1;
   int DwarfVersion;
+  /// Number of threads used to compress each debug section; 0 means one per
+  /// hardware thread.
+  unsigned CompressDebugSectionsThreads;
   /// getABIName - If this returns a non-empty string this represents the
   /// textual name of the ABI that we want the backend to use, e.g. o32, or
   /// aapcs-linux.
@@ -54,7 +59,9 @@ inline bool operator==(const MCTargetOptions &LHS, const MCTargetOptions &RHS) {
           ARE_EQUAL(ShowMCEncoding) &&
           ARE_EQUAL(ShowMCInst) &&
           ARE_EQUAL(AsmVerbose) &&
+          ARE_EQUAL(CompressDebugSectionsFast) &&
           ARE_EQUAL(DwarfVersion) &&
+          ARE_EQUAL(CompressDebugSectionsThreads) &&
 	  ARE_EQUAL(ABIName));
 #undef ARE_EQUAL
 }
@@ -40,6 +40,16 @@ cl::opt<bool> ShowMCInst("asm-show-inst",
                          cl::desc("Emit internal instruction representation to "
                                   "assembly file"));
 
+cl::opt<bool> CompressDebugSectionsFast(
+    "compress-debug-sections-fast",
+    cl::desc("Use the fastest zlib level when compressing debug sections"));
+
+cl::opt<unsigned> CompressDebugSectionsThreads(
+    "compress-debug-sections-threads",
+    cl::desc("Number of threads used to compress each debug section "
+             "(0 = one per hardware thread)"),
+    cl::init(1));
+
 cl::opt<std::string>
 ABIName("target-abi", cl::Hidden,
         cl::desc("The name of the ABI to be targeted from the backend."),
@@ -52,6 +62,8 @@ static inline MCTargetOptions InitMCTargetOptionsFromFlags() {
   Options.MCRelaxAll = RelaxAll;
   Options.DwarfVersion = DwarfVersion;
   Options.ShowMCInst = ShowMCInst;
+  Options.CompressDebugSectionsFast = CompressDebugSectionsFast;
+  Options.CompressDebugSectionsThreads = CompressDebugSectionsThreads;
   Options.ABIName = ABIName;
   return Options;
 }
@@ -51,6 +51,13 @@ class PassRegistry {
   std::vector<std::unique_ptr<const PassInfo>> ToFree;
   std::vector<PassRegistrationListener *> Listeners;
 
+  /// DeferredInitializers - Pass initialization functions that have not been
+  /// run yet, see addDeferredInitializer.
+  mutable std::vector<void (*)(PassRegistry &)> DeferredInitializers;
+
+  const PassInfo *findPassInfo(const void *TI) const;
+  const PassInfo *findPassInfo(StringRef Arg) const;
+
 public:
   PassRegistry() {}
   ~PassRegistry();
@@ -68,6 +75,20 @@ public:
   /// argument string.
   const PassInfo *getPassInfo(StringRef Arg) const;
 
+  /// addDeferredInitializer - Arrange for Init, typically one of the
+  /// initialize* functions from InitializePasses.h, to be run the first time a
+  /// pass is looked up that is not registered yet, rather than now. Tools that
+  /// only ever look passes up by ID or name can use this to avoid registering
+  /// hundreds of passes at startup. Passes registered this way are not seen by
+  /// enumerateWith until something has looked up a missing pass, so tools that
+  /// build command line options from the list of passes must register them
+  /// eagerly.
+  void addDeferredInitializer(void (*Init)(PassRegistry &));
+
+  /// runDeferredInitializers - Run the initializers added with
+  /// addDeferredInitializer. Returns true if there were any.
+  bool runDeferredInitializers() const;
+
   /// registerPass - Register a pass (by means of its PassInfo) with the
   /// registry.  Required in order to use the pass with a PassManager.
   void registerPass(const PassInfo &PI, bool ShouldFree = false);
@@ -211,6 +211,7 @@ public:
   const char *ValueStr; // String describing what the value of this option is
   OptionCategory *Category; // The Category this option belongs to
   bool FullyInitialized;    // Has addArguemnt been called?
+  Option *NextPending;      // Next option waiting to be added to the parser
 
   inline enum NumOccurrencesFlag getNumOccurrencesFlag() const {
     return (enum NumOccurrencesFlag)Occurrences;
@@ -251,7 +252,8 @@ protected:
       : NumOccurrences(0), Occurrences(OccurrencesFlag), Value(0),
         HiddenFlag(Hidden), Formatting(NormalFormatting), Misc(0), Position(0),
         AdditionalVals(0), ArgStr(""), HelpStr(""), ValueStr(""),
-        Category(&GeneralCategory), FullyInitialized(false) {}
+        Category(&GeneralCategory), FullyInitialized(false),
+        NextPending(nullptr) {}
 
   inline void setNumAdditionalVals(unsigned n) { AdditionalVals = n; }
 
@@ -17,6 +17,7 @@
 #include "llvm/Support/DataTypes.h"
 
 namespace llvm {
+template <typename T> class ArrayRef;
 template <typename T> class SmallVectorImpl;
 class StringRef;
 
@@ -43,6 +44,17 @@ bool isAvailable();
 Status compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                 CompressionLevel Level = DefaultCompression);
 
+/// Compress the concatenation of \p Inputs into a single zlib stream without
+/// first copying them into one contiguous buffer. The data is cut into blocks
+/// of \p BlockSize bytes which are deflated independently on up to \p Threads
+/// threads (0 means one per hardware thread). Every block is primed with the
+/// 32K of input preceding it and ends with a sync flush, so the blocks simply
+/// concatenate. With a single block the result is identical to compress().
+Status compressChunked(ArrayRef<StringRef> Inputs,
+                       SmallVectorImpl<char> &CompressedBuffer,
+                       CompressionLevel Level = DefaultCompression,
+                       unsigned Threads = 0, size_t BlockSize = 128 * 1024);
+
 Status uncompress(StringRef InputBuffer,
                   SmallVectorImpl<char> &UncompressedBuffer,
                   size_t UncompressedSize);
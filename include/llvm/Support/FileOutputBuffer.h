@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
 /// FileOutputBuffer - This interface provides simple way to create an in-memory
@@ -41,6 +42,14 @@ public:
                                 std::unique_ptr<FileOutputBuffer> &Result,
                                 unsigned Flags = 0);
 
+  /// Factory method to create an OutputBuffer object for the file at FilePath
+  /// that is already open as FD, e.g. one from sys::fs::createTemporaryFile.
+  /// The buffer takes ownership of FD and maps the file itself instead of a
+  /// temporary copy, so the file must not be in use by anyone else. As with
+  /// the other factory, the file is deleted unless the buffer is committed.
+  static std::error_code create(int FD, StringRef FilePath, size_t Size,
+                                std::unique_ptr<FileOutputBuffer> &Result);
+
   /// Returns a pointer to the start of the buffer.
   uint8_t *getBufferStart() {
     return (uint8_t*)Region->data();
@@ -61,12 +70,17 @@ public:
     return FinalPath;
   }
 
+  /// Grows the buffer to NewSize bytes, keeping its content. The buffer is
+  /// mapped again, so pointers into it are invalidated. If this fails, the
+  /// buffer is left unusable and can only be destroyed.
+  std::error_code grow(size_t NewSize);
+
   /// Flushes the content of the buffer to its file and deallocates the
   /// buffer.  If commit() is not called before this object's destructor
   /// is called, the file is deleted in the destructor. The optional parameter
   /// is used if it turns out you want the file size to be smaller than
   /// initially requested.
-  std::error_code commit();
+  std::error_code commit(int64_t NewSmallerSize = -1);
 
   /// If this object was previously committed, the destructor just deletes
   /// this object.  If this object was not committed, the destructor
@@ -84,6 +98,50 @@ private:
   SmallString<128>    FinalPath;
   SmallString<128>    TempPath;
 };
+
+/// raw_file_buffer_ostream - A raw_pwrite_stream that writes straight into a
+/// FileOutputBuffer, growing it as needed. The stream's buffer is the unused
+/// part of the mapped file, so output costs no system calls and no copies,
+/// and patching earlier output with pwrite is a memcpy. This suits large
+/// outputs that are written once and patched, like object files.
+///
+/// Like with FileOutputBuffer, the file only appears at its path when the
+/// stream is committed; otherwise the output is discarded.
+class raw_file_buffer_ostream : public raw_pwrite_stream {
+  std::unique_ptr<FileOutputBuffer> Buffer;
+
+  /// The number of bytes of the file written before the stream's buffer.
+  uint64_t Pos;
+
+  std::error_code EC;
+
+  void write_impl(const char *Ptr, size_t Size) override;
+  void pwrite_impl(const char *Ptr, size_t Size, uint64_t Offset) override;
+  uint64_t current_pos() const override { return Pos; }
+
+  /// Make room for at least Size bytes in the file buffer.
+  bool reserve(uint64_t Size);
+
+public:
+  /// Open the specified file for writing, with room for SizeHint bytes to
+  /// begin with. Flags are the FileOutputBuffer flags. If the file cannot be
+  /// opened, EC is set to the error and all output is discarded.
+  raw_file_buffer_ostream(StringRef Path, std::error_code &EC,
+                          size_t SizeHint = 1 << 20, unsigned Flags = 0);
+
+  /// Write to the file at Path that is already open as FD, see
+  /// FileOutputBuffer::create. The stream takes ownership of FD.
+  raw_file_buffer_ostream(int FD, StringRef Path, std::error_code &EC,
+                          size_t SizeHint = 1 << 20);
+  ~raw_file_buffer_ostream() override;
+
+  /// Trim the file to the output written so far and move it to its path.
+  /// Nothing can be written afterwards.
+  std::error_code commit();
+
+  /// Return the first error seen while writing, if any.
+  std::error_code error() const { return EC; }
+};
 } // end namespace llvm
 
 #endif
@@ -15,11 +15,14 @@
 #define LLVM_SUPPORT_MEMORYBUFFER_H
 
 #include "llvm-c/Support.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/CBindingWrapping.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/ErrorOr.h"
 #include <memory>
+#include <string>
 
 namespace llvm {
 class MemoryBufferRef;
@@ -124,6 +127,22 @@ public:
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileOrSTDIN(const Twine &Filename, int64_t FileSize = -1);
 
+  /// Read many files, or stdin for a Filename of "-", concurrently and hand
+  /// each result to Callback together with its index in Filenames.
+  ///
+  /// The files are opened and read by a pool of ThreadCount threads (0 means
+  /// one per hardware thread), which hides the latency of slow or remote file
+  /// systems. Callback is always called on the calling thread and in the order
+  /// of Filenames, as soon as a file and all the files before it have been
+  /// read, so the results can be consumed deterministically while later files
+  /// are still being read. Files are read into memory rather than mapped, and
+  /// at most two per thread are read ahead of the file being handed out.
+  static void getFilesOrSTDIN(
+      ArrayRef<std::string> Filenames,
+      function_ref<void(size_t, ErrorOr<std::unique_ptr<MemoryBuffer>>)>
+          Callback,
+      unsigned ThreadCount = 0);
+
   /// Map a subrange of the specified file as a MemoryBuffer.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileSlice(const Twine &Filename, uint64_t MapSize, uint64_t Offset);
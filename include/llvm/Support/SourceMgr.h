@@ -52,10 +52,20 @@ private:
     /// This is the location of the parent include, or null if at the top level.
     SMLoc IncludeLoc;
 
-    SrcBuffer() {}
+    /// The offsets of the newlines in the first NewlinesIndexedTo bytes of the
+    /// buffer, in order. This is built as far as line numbers are asked for.
+    mutable std::vector<unsigned> NewlineOffsets;
+    mutable size_t NewlinesIndexedTo;
+
+    SrcBuffer() : NewlinesIndexedTo(0) {}
 
     SrcBuffer(SrcBuffer &&O)
-        : Buffer(std::move(O.Buffer)), IncludeLoc(O.IncludeLoc) {}
+        : Buffer(std::move(O.Buffer)), IncludeLoc(O.IncludeLoc),
+          NewlineOffsets(std::move(O.NewlineOffsets)),
+          NewlinesIndexedTo(O.NewlinesIndexedTo) {}
+
+    /// Return the line number of the specified pointer into the buffer.
+    unsigned getLineNumber(const char *Ptr) const;
   };
 
   /// This is all of the buffers that we are reading from.
@@ -64,10 +74,6 @@ private:
   // This is the list of directories we should search for include files in.
   std::vector<std::string> IncludeDirectories;
 
-  /// This is a cache for line number queries, its implementation is really
-  /// private to SourceMgr.cpp.
-  mutable void *LineNoCache;
-
   DiagHandlerTy DiagHandler;
   void *DiagContext;
 
@@ -76,9 +82,7 @@ private:
   SourceMgr(const SourceMgr&) = delete;
   void operator=(const SourceMgr&) = delete;
 public:
-  SourceMgr()
-    : LineNoCache(nullptr), DiagHandler(nullptr), DiagContext(nullptr) {}
-  ~SourceMgr();
+  SourceMgr() : DiagHandler(nullptr), DiagContext(nullptr) {}
 
   void setIncludeDirs(const std::vector<std::string> &Dirs) {
     IncludeDirectories = Dirs;
@@ -144,13 +148,12 @@ public:
   unsigned FindBufferContainingLoc(SMLoc Loc) const;
 
   /// Find the line number for the specified location in the specified file.
-  /// This is not a fast method.
   unsigned FindLineNumber(SMLoc Loc, unsigned BufferID = 0) const {
     return getLineAndColumn(Loc, BufferID).first;
   }
 
   /// Find the line and column number for the specified location in the
-  /// specified file. This is not a fast method.
+  /// specified file.
   std::pair<unsigned, unsigned> getLineAndColumn(SMLoc Loc,
                                                  unsigned BufferID = 0) const;
 
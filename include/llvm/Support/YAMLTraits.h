@@ -770,10 +770,10 @@ yamlize(IO &io, T &Seq, bool) {
     unsigned count = io.outputting() ? SequenceTraits<T>::size(io, Seq) : incnt;
     for(unsigned i=0; i < count; ++i) {
       void *SaveInfo;
-      if ( io.preflightFlowElement(i, SaveInfo) ) {
-        yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
-        io.postflightFlowElement(SaveInfo);
-      }
+      if ( !io.preflightFlowElement(i, SaveInfo) )
+        break;
+      yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
+      io.postflightFlowElement(SaveInfo);
     }
     io.endFlowSequence();
   }
@@ -782,10 +782,10 @@ yamlize(IO &io, T &Seq, bool) {
     unsigned count = io.outputting() ? SequenceTraits<T>::size(io, Seq) : incnt;
     for(unsigned i=0; i < count; ++i) {
       void *SaveInfo;
-      if ( io.preflightElement(i, SaveInfo) ) {
-        yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
-        io.postflightElement(SaveInfo);
-      }
+      if ( !io.preflightElement(i, SaveInfo) )
+        break;
+      yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
+      io.postflightElement(SaveInfo);
     }
     io.endSequence();
   }
@@ -967,6 +967,10 @@ private:
 /// the mapRequired() method calls may not be in the same order
 /// as the keys in the document.
 ///
+/// In streaming mode (see setStreaming()) the HNodes are instead created as
+/// the document is mapped, so that large documents can be read without
+/// holding a copy of their whole structure.
+///
 class Input : public IO {
 public:
   // Construct a yaml Input object from a StringRef and optional
@@ -981,6 +985,16 @@ public:
   // Check if there was an syntax or semantic error during parsing.
   std::error_code error();
 
+  /// Read the documents in streaming mode. Rather than building the HNodes of
+  /// a whole document up front, the document is parsed as the traits ask for
+  /// keys and sequence elements. Entries of a mapping are only buffered when
+  /// a key is asked for before the ones preceding it in the document, and
+  /// sequence elements are freed as soon as they have been mapped. This keeps
+  /// memory use flat for documents whose keys are in the order the traits map
+  /// them, such as the ones written by Output. A sequence can only be mapped
+  /// once in this mode. Must be called before the first document is read.
+  void setStreaming(bool Enable) { Streaming = Enable; }
+
 private:
   bool outputting() override;
   bool mapTag(StringRef, bool) override;
@@ -1050,7 +1064,8 @@ private:
     void anchor() override;
 
   public:
-    MapHNode(Node *n) : HNode(n) { }
+    MapHNode(Node *n)
+        : HNode(n), IsStreaming(false), Started(false), Pending(nullptr) { }
 
     static inline bool classof(const HNode *n) {
       return MappingNode::classof(n->_node);
@@ -1063,13 +1078,21 @@ private:
 
     NameToNode                        Mapping;
     llvm::SmallVector<const char*, 6> ValidKeys;
+
+    // In streaming mode Mapping only holds the entries read so far, the rest
+    // are read starting at Next as keys are asked for. Pending is the value
+    // at Next while it is being mapped.
+    bool                              IsStreaming;
+    bool                              Started;
+    MappingNode::iterator             Next;
+    HNode                            *Pending;
   };
 
   class SequenceHNode : public HNode {
     void anchor() override;
 
   public:
-    SequenceHNode(Node *n) : HNode(n) { }
+    SequenceHNode(Node *n) : HNode(n), IsStreaming(false), Started(false) { }
 
     static inline bool classof(const HNode *n) {
       return SequenceNode::classof(n->_node);
@@ -1077,9 +1100,23 @@ private:
     static inline bool classof(const SequenceHNode *) { return true; }
 
     std::vector<std::unique_ptr<HNode>> Entries;
+
+    // In streaming mode the elements are read one at a time starting at
+    // Next, and Entries only holds the one being mapped.
+    bool                                IsStreaming;
+    bool                                Started;
+    SequenceNode::iterator              Next;
   };
 
   std::unique_ptr<Input::HNode> createHNodes(Node *node);
+  std::unique_ptr<Input::HNode> createStreamingHNode(Node *node);
+  bool readKey(KeyValueNode &KVN, StringRef &Key);
+  HNode *readMapEntry(MapHNode *MN, StringRef Key);
+  void finishMapEntry(MapHNode *MN);
+  HNode *readSequenceElement(SequenceHNode *SQ);
+  void finishSequenceElement(SequenceHNode *SQ);
+  void readAllElements(SequenceHNode *SQ);
+  void skipUnread(HNode *hnode);
   void setError(HNode *hnode, const Twine &message);
   void setError(Node *node, const Twine &message);
 
@@ -1103,6 +1140,7 @@ private:
   std::vector<bool>                   BitValuesUsed;
   HNode                              *CurrentNode;
   bool                                ScalarMatchFound;
+  bool                                Streaming;
 };
 
 
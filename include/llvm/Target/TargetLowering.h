@@ -34,6 +34,7 @@
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/Support/BranchProbability.h"
 #include "llvm/Target/TargetCallingConv.h"
 #include "llvm/Target/TargetMachine.h"
 #include <climits>
@@ -255,6 +256,11 @@ public:
     return PredictableSelectIsExpensive;
   }
 
+  /// Return the probability above which a biased branch or select is assumed
+  /// to be predicted right nearly every time, so that a branch is cheaper than
+  /// a select.
+  virtual BranchProbability getPredictableBranchThreshold() const;
+
   /// isLoadBitCastBeneficial() - Return true if the following transform
   /// is beneficial.
   /// fold (conv (load x)) -> (load (conv*)x)
@@ -970,6 +976,11 @@ public:
     return PrefLoopAlignment;
   }
 
+  /// Return the size of the aligned windows the processor fetches or caches
+  /// decoded instructions in, as log2(bytes). Hot code that straddles fewer
+  /// of them runs faster. Zero if the target does not care.
+  unsigned getFetchAlignment() const { return FetchAlignment; }
+
   /// Return whether the DAG builder should automatically insert fences and
   /// reduce ordering for atomics.
   bool getInsertFencesForAtomic() const {
@@ -1408,6 +1419,14 @@ protected:
     PrefLoopAlignment = Align;
   }
 
+  /// Set the target's instruction fetch window size, in log2(bytes). Hot
+  /// blocks are aligned to it when the padding fits a budget, which is only
+  /// known once the code is laid out; targets that compute block offsets
+  /// before emission must leave it at zero.
+  void setFetchAlignment(unsigned Align) {
+    FetchAlignment = Align;
+  }
+
   /// Set the minimum stack alignment of an argument (in log2(bytes)).
   void setMinStackArgumentAlignment(unsigned Align) {
     MinStackArgumentAlignment = Align;
@@ -1832,6 +1851,9 @@ private:
   /// The preferred loop alignment.
   unsigned PrefLoopAlignment;
 
+  /// The instruction fetch window size.
+  unsigned FetchAlignment;
+
   /// Whether the DAG builder should automatically insert fences and reduce
   /// ordering for atomics.  (This will be set for for most architectures with
   /// weak memory ordering.)
@@ -167,6 +167,10 @@ public:
   /// \brief Enable the use of the early if conversion pass.
   virtual bool enableEarlyIfConversion() const { return false; }
 
+  /// \brief Enable early if conversion of branches marked !unpredictable, even
+  /// if enableEarlyIfConversion() returns false.
+  virtual bool enableEarlyIfConversionOfUnpredictable() const { return false; }
+
   /// \brief Return PBQPConstraint(s) for the target.
   ///
   /// Override to provide custom PBQP constraints.
@@ -203,6 +203,12 @@ ModulePass *createBarrierNoopPass();
 /// to bitsets.
 ModulePass *createLowerBitSetsPass();
 
+//===----------------------------------------------------------------------===//
+/// createMultiVersioningPass - This pass clones functions marked with the
+/// "target-versions" attribute once per CPU feature set and dispatches between
+/// the clones at run time.
+ModulePass *createMultiVersioningPass();
+
 } // End llvm namespace
 
 #endif
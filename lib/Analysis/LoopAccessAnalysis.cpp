@@ -344,6 +344,13 @@ bool AccessAnalysis::canCheckPtrAtRT(
         RtCheck.insert(SE, TheLoop, Ptr, IsWrite, DepId, ASId, StridesMap);
 
         DEBUG(dbgs() << "LAA: Found a runtime check ptr:" << *Ptr << '\n');
+      } else if (std::next(AS.begin()) == AS.end() &&
+                 !(IsWrite && Accesses.count(MemAccessInfo(Ptr, false)))) {
+        // A pointer alone in its alias set cannot overlap any other access
+        // in the loop, so it needs no bounds unless it is both read and
+        // written (e.g. a[b[i]]++).
+        DEBUG(dbgs() << "LAA: No runtime check needed for ptr:" << *Ptr
+                     << '\n');
       } else {
         DEBUG(dbgs() << "LAA: Can't find bounds for ptr:" << *Ptr << '\n');
         CanDoRT = false;
@@ -1620,7 +1620,8 @@ void AsmPrinter::EmitLabelPlusOffset(const MCSymbol *Label, uint64_t Offset,
 // an explicit alignment requested, it will override the alignment request
 // if required for correctness.
 //
-void AsmPrinter::EmitAlignment(unsigned NumBits, const GlobalObject *GV) const {
+void AsmPrinter::EmitAlignment(unsigned NumBits, const GlobalObject *GV,
+                               unsigned MaxBytesToEmit) const {
   if (GV)
     NumBits = getGVAlignmentLog2(GV, *TM.getDataLayout(),
                                  NumBits);
@@ -1631,9 +1632,9 @@ void AsmPrinter::EmitAlignment(unsigned NumBits, const GlobalObject *GV) const {
              static_cast<unsigned>(std::numeric_limits<unsigned>::digits) &&
          "undefined behavior");
   if (getCurrentSection()->getKind().isText())
-    OutStreamer->EmitCodeAlignment(1u << NumBits);
+    OutStreamer->EmitCodeAlignment(1u << NumBits, MaxBytesToEmit);
   else
-    OutStreamer->EmitValueToAlignment(1u << NumBits);
+    OutStreamer->EmitValueToAlignment(1u << NumBits, 0, 1, MaxBytesToEmit);
 }
 
 //===----------------------------------------------------------------------===//
@@ -2378,8 +2379,13 @@ static void emitBasicBlockLoopComments(const MachineBasicBlock &MBB,
 /// it if appropriate.
 void AsmPrinter::EmitBasicBlockStart(const MachineBasicBlock &MBB) const {
   // Emit an alignment directive for this block, if needed.
-  if (unsigned Align = MBB.getAlignment())
+  unsigned Align = MBB.getAlignment();
+  if (Align)
     EmitAlignment(Align);
+  // The assembler skips this one if it would take too much padding.
+  if (MBB.getPaddedAlignment() > Align)
+    EmitAlignment(MBB.getPaddedAlignment(), nullptr,
+                  MBB.getPaddedAlignmentMaxBytes());
 
   // If the block has its address taken, emit any labels that were used to
   // reference the block.  It is possible that there is more than one label
@@ -104,6 +104,12 @@ DwarfPubSections("generate-dwarf-pub-sections", cl::Hidden,
                             clEnumVal(Disable, "Disabled"), clEnumValEnd),
                  cl::init(Default));
 
+static cl::opt<bool> FinishFunctionsEarly(
+    "dwarf-finish-functions-early", cl::Hidden,
+    cl::desc("Finish the variable DIEs of each function once the function "
+             "has been emitted, rather than at the end of the module"),
+    cl::init(true));
+
 static const char *const DWARFGroupName = "DWARF Emission";
 static const char *const DbgTimerName = "DWARF Debug Writer";
 
@@ -479,23 +485,50 @@ void DwarfDebug::beginModule() {
   MMI->setDebugInfoAvailability(true);
 }
 
+void DwarfDebug::finishVariableDefinition(const DbgVariable &Var) {
+  DIE *VariableDie = Var.getDIE();
+  assert(VariableDie);
+  // FIXME: Consider the time-space tradeoff of just storing the unit pointer
+  // in the ConcreteVariables list, rather than looking it up again here.
+  // DIE::getUnit isn't simple - it walks parent pointers, etc.
+  DwarfCompileUnit *Unit = lookupUnit(VariableDie->getUnit());
+  assert(Unit);
+  DbgVariable *AbsVar = getExistingAbstractVariable(
+      InlinedVariable(Var.getVariable(), Var.getInlinedAt()));
+  if (AbsVar && AbsVar->getDIE()) {
+    Unit->addDIEEntry(*VariableDie, dwarf::DW_AT_abstract_origin,
+                      *AbsVar->getDIE());
+  } else
+    Unit->applyVariableAttributes(Var, *VariableDie);
+}
+
 void DwarfDebug::finishVariableDefinitions() {
+  for (const auto &Var : ConcreteVariables)
+    finishVariableDefinition(*Var);
+  for (const UnfinishedVariable &UV : UnfinishedVariables) {
+    DbgVariable Var(UV.Var, UV.IA, this);
+    Var.setDIE(*UV.VariableDie);
+    finishVariableDefinition(Var);
+  }
+}
+
+void DwarfDebug::finishFunctionVariables() {
+  // A variable whose abstract variable already has a DIE is settled: it will
+  // reference that DIE whatever the rest of the module looks like. Only the
+  // others have to wait for finalizeModuleInfo, since a later function may
+  // still inline their subprogram.
   for (const auto &Var : ConcreteVariables) {
-    DIE *VariableDie = Var->getDIE();
-    assert(VariableDie);
-    // FIXME: Consider the time-space tradeoff of just storing the unit pointer
-    // in the ConcreteVariables list, rather than looking it up again here.
-    // DIE::getUnit isn't simple - it walks parent pointers, etc.
-    DwarfCompileUnit *Unit = lookupUnit(VariableDie->getUnit());
-    assert(Unit);
     DbgVariable *AbsVar = getExistingAbstractVariable(
         InlinedVariable(Var->getVariable(), Var->getInlinedAt()));
     if (AbsVar && AbsVar->getDIE()) {
-      Unit->addDIEEntry(*VariableDie, dwarf::DW_AT_abstract_origin,
-                        *AbsVar->getDIE());
-    } else
-      Unit->applyVariableAttributes(*Var, *VariableDie);
+      finishVariableDefinition(*Var);
+      continue;
+    }
+    UnfinishedVariable UV = {Var->getDIE(), Var->getVariable(),
+                             Var->getInlinedAt()};
+    UnfinishedVariables.push_back(UV);
   }
+  ConcreteVariables.clear();
 }
 
 void DwarfDebug::finishSubprogramDefinitions() {
@@ -1232,6 +1265,9 @@ void DwarfDebug::endFunction(const MachineFunction *MF) {
     if (!LScopes.getAbstractScopesList().empty())
       SkelCU->constructSubprogramScopeDIE(FnScope);
 
+  if (FinishFunctionsEarly)
+    finishFunctionVariables();
+
   // Clear debug info
   // Ownership of DbgVariables is a bit subtle - ScopeVariables owns all the
   // DbgVariables except those that are also in AbstractVariables (since they
@@ -1904,6 +1940,13 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
   if (!TypeUnitsUnderConstruction.empty() && AddrPool.hasBeenUsed())
     return;
 
+  // A type already known to need the address pool would only be built into
+  // type units and thrown out again, so build it in the CU directly.
+  if (TypeUnitsUnderConstruction.empty() && TypesNotInTypeUnits.count(CTy)) {
+    CU.constructTypeDIE(RefDie, cast<DICompositeType>(CTy));
+    return;
+  }
+
   const DwarfTypeUnit *&TU = DwarfTypeUnits[CTy];
   if (TU) {
     CU.addDIETypeSignature(RefDie, *TU);
@@ -1951,6 +1994,7 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
       // the type that used an address.
       for (const auto &TU : TypeUnitsToAdd)
         DwarfTypeUnits.erase(TU.second);
+      TypesNotInTypeUnits.insert(CTy);
 
       // Construct this type in the CU directly.
       // This is inefficient because all the dependent types will be rebuilt
@@ -235,6 +235,19 @@ class DwarfDebug : public AsmPrinterHandler {
   DenseMap<const MDNode *, std::unique_ptr<DbgVariable>> AbstractVariables;
   SmallVector<std::unique_ptr<DbgVariable>, 64> ConcreteVariables;
 
+  /// A concrete variable DIE of a finished function whose abstract origin was
+  /// not yet known when the function was finished.
+  struct UnfinishedVariable {
+    DIE *VariableDie;
+    const DILocalVariable *Var;
+    const DILocation *IA;
+  };
+
+  // Variables of finished functions left for finalizeModuleInfo when
+  // functions are finished early. This replaces the DbgVariables in
+  // ConcreteVariables, which otherwise stay alive until the end of the module.
+  std::vector<UnfinishedVariable> UnfinishedVariables;
+
   // Collection of DebugLocEntry. Stored in a linked list so that DIELocLists
   // can refer to them in spite of insertions into this list.
   DebugLocStream DebugLocs;
@@ -294,6 +307,11 @@ class DwarfDebug : public AsmPrinterHandler {
       std::pair<std::unique_ptr<DwarfTypeUnit>, const DICompositeType *>, 1>
       TypeUnitsUnderConstruction;
 
+  // Types that could not be placed in a type unit because they reference the
+  // address pool. Later CUs build these in place straight away rather than
+  // rebuilding the type units only to throw them out again.
+  DenseSet<const MDNode *> TypesNotInTypeUnits;
+
   // Whether to emit the pubnames/pubtypes sections.
   bool HasDwarfPubSections;
 
@@ -378,8 +396,16 @@ class DwarfDebug : public AsmPrinterHandler {
   /// \brief Collect info for variables that were optimized out.
   void collectDeadVariables();
 
+  /// \brief Add either DW_AT_abstract_origin or the variable's own
+  /// attributes to the DIE of a concrete variable.
+  void finishVariableDefinition(const DbgVariable &Var);
+
   void finishVariableDefinitions();
 
+  /// \brief Finish the variables of the current function so that their
+  /// DbgVariables can be released.
+  void finishFunctionVariables();
+
   void finishSubprogramDefinitions();
 
   /// \brief Finish off debug information after all functions have been
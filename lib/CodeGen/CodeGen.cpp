@@ -41,6 +41,7 @@ void llvm::initializeCodeGen(PassRegistry &Registry) {
   initializeMachineBlockFrequencyInfoPass(Registry);
   initializeMachineBlockPlacementPass(Registry);
   initializeMachineBlockPlacementStatsPass(Registry);
+  initializeHotBlockAlignmentPass(Registry);
   initializeMachineCSEPass(Registry);
   initializeImplicitNullChecksPass(Registry);
   initializeMachineCombinerPass(Registry);
@@ -15,6 +15,7 @@
 
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/InstructionSimplify.h"
@@ -68,6 +69,10 @@ STATISTIC(NumDbgValueMoved, "Number of debug value instructions moved");
 STATISTIC(NumSelectsExpanded, "Number of selects turned into branches");
 STATISTIC(NumAndCmpsMoved, "Number of and/cmp's pushed into branches");
 STATISTIC(NumStoreExtractExposed, "Number of store(extractelement) exposed");
+STATISTIC(NumAddrModesReused, "Number of memory instructions that reused an "
+                              "address already sunk into their block");
+STATISTIC(NumBlocksSkipped, "Number of unchanged blocks skipped when "
+                            "re-optimizing huge functions");
 
 static cl::opt<bool> DisableBranchOpts(
   "disable-cgp-branch-opts", cl::Hidden, cl::init(false),
@@ -107,6 +112,11 @@ static cl::opt<bool> StressExtLdPromotion(
     cl::desc("Stress test ext(promotable(ld)) -> promoted(ext(ld)) "
              "optimization in CodeGenPrepare"));
 
+static cl::opt<unsigned> HugeFuncThreshold(
+    "cgp-huge-func", cl::Hidden, cl::init(10000),
+    cl::desc("Number of basic blocks above which CodeGenPrepare only revisits "
+             "blocks affected by the previous iteration (0 = never)"));
+
 namespace {
 typedef SmallPtrSet<Instruction *, 16> SetOfInstrs;
 struct TypeIsSExt {
@@ -135,6 +145,17 @@ class TypePromotionTransaction;
     /// multiple load/stores of the same address.
     ValueMap<Value*, Value*> SunkAddrs;
 
+    /// Addresses, together with the access type and address space they were
+    /// matched for, whose addressing mode has already been sunk into the
+    /// current block. A later access with the same key reuses the entry in
+    /// SunkAddrs without running the addressing mode matcher again.
+    DenseSet<std::pair<Value *, std::pair<Type *, unsigned>>> SunkAddrModes;
+
+    /// Blocks that must be revisited on the next iteration over a huge
+    /// function: blocks changed by the current iteration and the blocks that
+    /// feed or use their instructions.
+    SmallPtrSet<BasicBlock *, 32> FreshBBs;
+
     /// Keeps track of all instructions inserted for the current function.
     SetOfInstrs InsertedInsts;
     /// Keeps track of the type of the related instruction before their
@@ -168,10 +189,17 @@ class TypePromotionTransaction;
     bool EliminateMostlyEmptyBlocks(Function &F);
     bool CanMergeBlocks(const BasicBlock *BB, const BasicBlock *DestBB) const;
     void EliminateMostlyEmptyBlock(BasicBlock *BB);
+    void clearSunkAddrs() {
+      SunkAddrs.clear();
+      SunkAddrModes.clear();
+    }
+    void markFresh(BasicBlock &BB);
     bool OptimizeBlock(BasicBlock &BB, bool& ModifiedDT);
     bool OptimizeInst(Instruction *I, bool& ModifiedDT);
     bool OptimizeMemoryInst(Instruction *I, Value *Addr,
                             Type *AccessTy, unsigned AS);
+    bool ReplaceSunkAddr(Instruction *MemoryInst, Value *Repl,
+                         Value *SunkAddr);
     bool OptimizeInlineAsmInst(CallInst *CS);
     bool OptimizeCallInst(CallInst *CI, bool& ModifiedDT);
     bool MoveExtToFormExtLoad(Instruction *&I);
@@ -242,22 +270,45 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
     EverMadeChange |= splitBranchCondition(F);
   }
 
+  // Revisiting every block until nothing changes is quadratic in the worst
+  // case. For huge functions, only the blocks affected by the previous
+  // iteration are visited again once the whole function has been seen.
+  bool IsHugeFunc = HugeFuncThreshold && F.size() > HugeFuncThreshold;
+  bool VisitAll = true;
+  FreshBBs.clear();
+
   bool MadeChange = true;
   while (MadeChange) {
     MadeChange = false;
+    SmallPtrSet<BasicBlock *, 32> VisitBBs;
+    if (!VisitAll)
+      VisitBBs.swap(FreshBBs);
+    VisitAll = !IsHugeFunc;
     for (Function::iterator I = F.begin(); I != F.end(); ) {
       BasicBlock *BB = I++;
+      if (!VisitBBs.empty() && !VisitBBs.count(BB)) {
+        ++NumBlocksSkipped;
+        continue;
+      }
       bool ModifiedDTOnIteration = false;
-      MadeChange |= OptimizeBlock(*BB, ModifiedDTOnIteration);
+      bool Changed = OptimizeBlock(*BB, ModifiedDTOnIteration);
+      MadeChange |= Changed;
 
       // Restart BB iteration if the dominator tree of the Function was changed
-      if (ModifiedDTOnIteration)
+      if (ModifiedDTOnIteration) {
+        // BB may have been deleted and the blocks after it were not visited;
+        // look at the whole function again.
+        VisitAll = true;
         break;
+      }
+      if (IsHugeFunc && Changed)
+        markFresh(*BB);
     }
     EverMadeChange |= MadeChange;
   }
 
-  SunkAddrs.clear();
+  clearSunkAddrs();
+  FreshBBs.clear();
 
   if (!DisableBranchOpts) {
     MadeChange = false;
@@ -309,6 +360,21 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
   return EverMadeChange;
 }
 
+/// markFresh - BB was changed by the current iteration. Record it, and the
+/// blocks defining its operands or using its values, since sinking moves code
+/// between exactly those blocks.
+void CodeGenPrepare::markFresh(BasicBlock &BB) {
+  FreshBBs.insert(&BB);
+  for (Instruction &I : BB) {
+    for (Value *Op : I.operands())
+      if (Instruction *OpI = dyn_cast<Instruction>(Op))
+        FreshBBs.insert(OpI->getParent());
+    for (User *U : I.users())
+      if (Instruction *UI = dyn_cast<Instruction>(U))
+        FreshBBs.insert(UI->getParent());
+  }
+}
+
 /// EliminateFallThrough - Merge basic blocks which are connected
 /// by a single edge, where one of the basic blocks has a single successor
 /// pointing to the other basic block, which has a single predecessor.
@@ -1287,6 +1353,254 @@ static void ScalarizeMaskedStore(CallInst *CI) {
   CI->eraseFromParent();
 }
 
+// ScalarizeMaskedGather() translates masked gather intrinsic, like
+// <16 x i32> @llvm.masked.gather.v16i32( <16 x i32*> %Ptrs, i32 4,
+//                               <16 x i1> %Mask, <16 x i32> %Src)
+// to a chain of basic blocks, with loading element one-by-one if
+// the appropriate mask bit is set
+//
+// %Ptrs = getelementptr i32, i32* %base, <16 x i64> %ind
+// %Mask0 = extractelement <16 x i1> %Mask, i32 0
+// %ToLoad0 = icmp eq i1 %Mask0, true
+// br i1 %ToLoad0, label %cond.load, label %else
+//
+// cond.load:
+// %Ptr0 = extractelement <16 x i32*> %Ptrs, i32 0
+// %Load0 = load i32, i32* %Ptr0, align 4
+// %Res0 = insertelement <16 x i32> undef, i32 %Load0, i32 0
+// br label %else
+//
+// else:
+// %res.phi.else = phi <16 x i32>[%Res0, %cond.load], [undef, % 0]
+// %Mask1 = extractelement <16 x i1> %Mask, i32 1
+// %ToLoad1 = icmp eq i1 %Mask1, true
+// br i1 %ToLoad1, label %cond.load1, label %else2
+//
+// cond.load1:
+// %Ptr1 = extractelement <16 x i32*> %Ptrs, i32 1
+// %Load1 = load i32, i32* %Ptr1, align 4
+// %Res1 = insertelement <16 x i32> %res.phi.else, i32 %Load1, i32 1
+// br label %else2
+// . . .
+// %Result = select <16 x i1> %Mask, <16 x i32> %res.phi.select, <16 x i32> %Src
+// ret <16 x i32> %Result
+static void ScalarizeMaskedGather(CallInst *CI) {
+  Value *Ptrs = CI->getArgOperand(0);
+  Value *Alignment = CI->getArgOperand(1);
+  Value *Mask = CI->getArgOperand(2);
+  Value *Src0 = CI->getArgOperand(3);
+
+  VectorType *VecType = dyn_cast<VectorType>(CI->getType());
+
+  assert(VecType && "Unexpected return type of masked load intrinsic");
+
+  IRBuilder<> Builder(CI->getContext());
+  Instruction *InsertPt = CI;
+  BasicBlock *IfBlock = CI->getParent();
+  BasicBlock *CondBlock = nullptr;
+  BasicBlock *PrevIfBlock = CI->getParent();
+  Builder.SetInsertPoint(InsertPt);
+  unsigned AlignVal = cast<ConstantInt>(Alignment)->getZExtValue();
+
+  Builder.SetCurrentDebugLocation(CI->getDebugLoc());
+
+  Value *UndefVal = UndefValue::get(VecType);
+
+  // The result vector
+  Value *VResult = UndefVal;
+  unsigned VectorWidth = VecType->getNumElements();
+
+  // Shorten the way if the mask is a vector of constants.
+  bool IsConstMask = isa<ConstantVector>(Mask) ||
+                     isa<ConstantAggregateZero>(Mask);
+
+  if (IsConstMask) {
+    for (unsigned Idx = 0; Idx < VectorWidth; ++Idx) {
+      Constant *Elt = cast<Constant>(Mask)->getAggregateElement(Idx);
+      if (!Elt->isNullValue()) {
+        Value *Ptr = Builder.CreateExtractElement(Ptrs, Builder.getInt32(Idx),
+                                                  "Ptr" + Twine(Idx));
+        LoadInst *Load = Builder.CreateAlignedLoad(Ptr, AlignVal,
+                                                   "Load" + Twine(Idx));
+        VResult = Builder.CreateInsertElement(VResult, Load,
+                                              Builder.getInt32(Idx),
+                                              "Res" + Twine(Idx));
+      }
+    }
+    Value *NewI = Builder.CreateSelect(Mask, VResult, Src0);
+    CI->replaceAllUsesWith(NewI);
+    CI->eraseFromParent();
+    return;
+  }
+
+  PHINode *Phi = nullptr;
+  Value *PrevPhi = UndefVal;
+
+  for (unsigned Idx = 0; Idx < VectorWidth; ++Idx) {
+
+    // Fill the "else" block, created in the previous iteration
+    //
+    //  %Mask1 = extractelement <16 x i1> %Mask, i32 1
+    //  %ToLoad1 = icmp eq i1 %Mask1, true
+    //  br i1 %ToLoad1, label %cond.load, label %else
+    //
+    if (Idx > 0) {
+      Phi = Builder.CreatePHI(VecType, 2, "res.phi.else");
+      Phi->addIncoming(VResult, CondBlock);
+      Phi->addIncoming(PrevPhi, PrevIfBlock);
+      PrevPhi = Phi;
+      VResult = Phi;
+    }
+
+    Value *Predicate = Builder.CreateExtractElement(Mask,
+                                                    Builder.getInt32(Idx),
+                                                    "Mask" + Twine(Idx));
+    Value *Cmp = Builder.CreateICmp(ICmpInst::ICMP_EQ, Predicate,
+                                    ConstantInt::get(Predicate->getType(), 1),
+                                    "ToLoad" + Twine(Idx));
+
+    // Create "cond" block
+    //
+    //  %EltAddr = getelementptr i32* %1, i32 0
+    //  %Elt = load i32* %EltAddr
+    //  VResult = insertelement <16 x i32> VResult, i32 %Elt, i32 Idx
+    //
+    CondBlock = IfBlock->splitBasicBlock(InsertPt, "cond.load");
+    Builder.SetInsertPoint(InsertPt);
+
+    Value *Ptr = Builder.CreateExtractElement(Ptrs, Builder.getInt32(Idx),
+                                              "Ptr" + Twine(Idx));
+    LoadInst *Load = Builder.CreateAlignedLoad(Ptr, AlignVal,
+                                               "Load" + Twine(Idx));
+    VResult = Builder.CreateInsertElement(VResult, Load, Builder.getInt32(Idx),
+                                          "Res" + Twine(Idx));
+
+    // Create "else" block, fill it in the next iteration
+    BasicBlock *NewIfBlock = CondBlock->splitBasicBlock(InsertPt, "else");
+    Builder.SetInsertPoint(InsertPt);
+    Instruction *OldBr = IfBlock->getTerminator();
+    BranchInst::Create(CondBlock, NewIfBlock, Cmp, OldBr);
+    OldBr->eraseFromParent();
+    PrevIfBlock = IfBlock;
+    IfBlock = NewIfBlock;
+  }
+
+  Phi = Builder.CreatePHI(VecType, 2, "res.phi.select");
+  Phi->addIncoming(VResult, CondBlock);
+  Phi->addIncoming(PrevPhi, PrevIfBlock);
+  Value *NewI = Builder.CreateSelect(Mask, Phi, Src0);
+  CI->replaceAllUsesWith(NewI);
+  CI->eraseFromParent();
+}
+
+// ScalarizeMaskedScatter() translates masked scatter intrinsic, like
+// void @llvm.masked.scatter.v16i32(<16 x i32> %Src, <16 x i32*> %Ptrs, i32 4,
+//                                  <16 x i1> %Mask)
+// to a chain of basic blocks, that stores element one-by-one if
+// the appropriate mask bit is set.
+//
+// %Ptrs = getelementptr i32, i32* %ptr, <16 x i64> %ind
+// %Mask0 = extractelement <16 x i1> %Mask, i32 0
+// %ToStore0 = icmp eq i1 %Mask0, true
+// br i1 %ToStore0, label %cond.store, label %else
+//
+// cond.store:
+// %Elt0 = extractelement <16 x i32> %Src, i32 0
+// %Ptr0 = extractelement <16 x i32*> %Ptrs, i32 0
+// store i32 %Elt0, i32* %Ptr0, align 4
+// br label %else
+//
+// else:
+// %Mask1 = extractelement <16 x i1> %Mask, i32 1
+// %ToStore1 = icmp eq i1 %Mask1, true
+// br i1 %ToStore1, label %cond.store1, label %else2
+//
+// cond.store1:
+// %Elt1 = extractelement <16 x i32> %Src, i32 1
+// %Ptr1 = extractelement <16 x i32*> %Ptrs, i32 1
+// store i32 %Elt1, i32* %Ptr1, align 4
+// br label %else2
+//   . . .
+static void ScalarizeMaskedScatter(CallInst *CI) {
+  Value *Src = CI->getArgOperand(0);
+  Value *Ptrs = CI->getArgOperand(1);
+  Value *Alignment = CI->getArgOperand(2);
+  Value *Mask = CI->getArgOperand(3);
+
+  assert(isa<VectorType>(Src->getType()) &&
+         "Unexpected data type in masked scatter intrinsic");
+  assert(isa<VectorType>(Ptrs->getType()) &&
+         isa<PointerType>(Ptrs->getType()->getVectorElementType()) &&
+         "Vector of pointers is expected in masked scatter intrinsic");
+
+  IRBuilder<> Builder(CI->getContext());
+  Instruction *InsertPt = CI;
+  BasicBlock *IfBlock = CI->getParent();
+  Builder.SetInsertPoint(InsertPt);
+  Builder.SetCurrentDebugLocation(CI->getDebugLoc());
+
+  unsigned AlignVal = cast<ConstantInt>(Alignment)->getZExtValue();
+  unsigned VectorWidth = Src->getType()->getVectorNumElements();
+
+  // Shorten the way if the mask is a vector of constants.
+  bool IsConstMask = isa<ConstantVector>(Mask) ||
+                     isa<ConstantAggregateZero>(Mask);
+
+  if (IsConstMask) {
+    for (unsigned Idx = 0; Idx < VectorWidth; ++Idx) {
+      Constant *Elt = cast<Constant>(Mask)->getAggregateElement(Idx);
+      if (Elt->isNullValue())
+        continue;
+      Value *OneElt = Builder.CreateExtractElement(Src, Builder.getInt32(Idx),
+                                                   "Elt" + Twine(Idx));
+      Value *Ptr = Builder.CreateExtractElement(Ptrs, Builder.getInt32(Idx),
+                                                "Ptr" + Twine(Idx));
+      Builder.CreateAlignedStore(OneElt, Ptr, AlignVal);
+    }
+    CI->eraseFromParent();
+    return;
+  }
+  for (unsigned Idx = 0; Idx < VectorWidth; ++Idx) {
+    // Fill the "else" block, created in the previous iteration
+    //
+    //  %Mask1 = extractelement <16 x i1> %Mask, i32 Idx
+    //  %ToStore = icmp eq i1 %Mask1, true
+    //  br i1 %ToStore, label %cond.store, label %else
+    //
+    Value *Predicate = Builder.CreateExtractElement(Mask,
+                                                    Builder.getInt32(Idx),
+                                                    "Mask" + Twine(Idx));
+    Value *Cmp =
+       Builder.CreateICmp(ICmpInst::ICMP_EQ, Predicate,
+                          ConstantInt::get(Predicate->getType(), 1),
+                          "ToStore" + Twine(Idx));
+
+    // Create "cond" block
+    //
+    //  %Elt1 = extractelement <16 x i32> %Src, i32 1
+    //  %Ptr1 = extractelement <16 x i32*> %Ptrs, i32 1
+    //  store i32 %Elt1, i32* %Ptr1
+    //
+    BasicBlock *CondBlock = IfBlock->splitBasicBlock(InsertPt, "cond.store");
+    Builder.SetInsertPoint(InsertPt);
+
+    Value *OneElt = Builder.CreateExtractElement(Src, Builder.getInt32(Idx),
+                                                 "Elt" + Twine(Idx));
+    Value *Ptr = Builder.CreateExtractElement(Ptrs, Builder.getInt32(Idx),
+                                              "Ptr" + Twine(Idx));
+    Builder.CreateAlignedStore(OneElt, Ptr, AlignVal);
+
+    // Create "else" block, fill it in the next iteration
+    BasicBlock *NewIfBlock = CondBlock->splitBasicBlock(InsertPt, "else");
+    Builder.SetInsertPoint(InsertPt);
+    Instruction *OldBr = IfBlock->getTerminator();
+    BranchInst::Create(CondBlock, NewIfBlock, Cmp, OldBr);
+    OldBr->eraseFromParent();
+    IfBlock = NewIfBlock;
+  }
+  CI->eraseFromParent();
+}
+
 bool CodeGenPrepare::OptimizeCallInst(CallInst *CI, bool& ModifiedDT) {
   BasicBlock *BB = CI->getParent();
 
@@ -1299,7 +1613,7 @@ bool CodeGenPrepare::OptimizeCallInst(CallInst *CI, bool& ModifiedDT) {
       CurInstIterator = BB->begin();
       // Avoid processing instructions out of order, which could cause
       // reuse before a value is defined.
-      SunkAddrs.clear();
+      clearSunkAddrs();
       return true;
     }
     // Sink address computing for memory operands into the block.
@@ -1377,7 +1691,7 @@ bool CodeGenPrepare::OptimizeCallInst(CallInst *CI, bool& ModifiedDT) {
       // start of the block.
       if (IterHandle != CurInstIterator) {
         CurInstIterator = BB->begin();
-        SunkAddrs.clear();
+        clearSunkAddrs();
       }
       return true;
     }
@@ -1398,6 +1712,22 @@ bool CodeGenPrepare::OptimizeCallInst(CallInst *CI, bool& ModifiedDT) {
       }
       return false;
     }
+    case Intrinsic::masked_gather: {
+      if (!TTI->isLegalMaskedGather(CI->getType())) {
+        ScalarizeMaskedGather(CI);
+        ModifiedDT = true;
+        return true;
+      }
+      return false;
+    }
+    case Intrinsic::masked_scatter: {
+      if (!TTI->isLegalMaskedScatter(CI->getArgOperand(0)->getType())) {
+        ScalarizeMaskedScatter(CI);
+        ModifiedDT = true;
+        return true;
+      }
+      return false;
+    }
     case Intrinsic::aarch64_stlxr:
     case Intrinsic::aarch64_stxr: {
       ZExtInst *ExtVal = dyn_cast<ZExtInst>(CI->getArgOperand(0));
@@ -3204,6 +3534,26 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
                                         Type *AccessTy, unsigned AddrSpace) {
   Value *Repl = Addr;
 
+  // If the same address was already matched for this kind of access and sunk
+  // into this block, the matcher would come to the same conclusion; just reuse
+  // the sunk computation.
+  auto AddrModeKey = std::make_pair(Addr, std::make_pair(AccessTy, AddrSpace));
+  if (SunkAddrModes.count(AddrModeKey)) {
+    auto It = SunkAddrs.find(Addr);
+    if (It != SunkAddrs.end() && It->second) {
+      Value *SunkAddr = It->second;
+      DEBUG(dbgs() << "CGP: Reusing matched nonlocal addrmode for "
+                   << *MemoryInst << "\n");
+      if (SunkAddr->getType() != Addr->getType()) {
+        IRBuilder<> Builder(MemoryInst);
+        SunkAddr = Builder.CreateBitCast(SunkAddr, Addr->getType());
+        It->second = SunkAddr;
+      }
+      ++NumAddrModesReused;
+      return ReplaceSunkAddr(MemoryInst, Repl, SunkAddr);
+    }
+  }
+
   // Try to collapse single-value PHI nodes.  This is necessary to undo
   // unprofitable PRE transformations.
   SmallVector<Value*, 8> worklist;
@@ -3514,6 +3864,14 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
       SunkAddr = Builder.CreateIntToPtr(Result, Addr->getType(), "sunkaddr");
   }
 
+  SunkAddrModes.insert(AddrModeKey);
+  return ReplaceSunkAddr(MemoryInst, Repl, SunkAddr);
+}
+
+/// ReplaceSunkAddr - Make MemoryInst use SunkAddr instead of Repl, and clean up
+/// Repl if it became dead.
+bool CodeGenPrepare::ReplaceSunkAddr(Instruction *MemoryInst, Value *Repl,
+                                     Value *SunkAddr) {
   MemoryInst->replaceUsesOfWith(Repl, SunkAddr);
 
   // If we have no uses, recursively delete the value and all dead instructions
@@ -3530,7 +3888,7 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
       // If the iterator instruction was recursively deleted, start over at the
       // start of the block.
       CurInstIterator = BB->begin();
-      SunkAddrs.clear();
+      clearSunkAddrs();
     }
   }
   ++NumMemoryInsts;
@@ -3842,13 +4200,40 @@ bool CodeGenPrepare::OptimizeExtUses(Instruction *I) {
   return MadeChange;
 }
 
+/// Return true if the branch weights on \p I say that its condition almost
+/// always goes the same way, so a branch on it would be predicted right.
+static bool hasPredictableProfile(const Instruction *I,
+                                  const TargetLowering *TLI) {
+  MDNode *Prof = I->getMetadata(LLVMContext::MD_prof);
+  if (!Prof || Prof->getNumOperands() != 3)
+    return false;
+  MDString *Name = dyn_cast<MDString>(Prof->getOperand(0));
+  if (!Name || Name->getString() != "branch_weights")
+    return false;
+  ConstantInt *TrueWeight =
+      mdconst::dyn_extract<ConstantInt>(Prof->getOperand(1));
+  ConstantInt *FalseWeight =
+      mdconst::dyn_extract<ConstantInt>(Prof->getOperand(2));
+  if (!TrueWeight || !FalseWeight)
+    return false;
+
+  uint64_t Max = std::max(TrueWeight->getZExtValue(),
+                          FalseWeight->getZExtValue());
+  uint64_t Sum = TrueWeight->getZExtValue() + FalseWeight->getZExtValue();
+  if (!Sum)
+    return false;
+  BranchProbability Threshold = TLI->getPredictableBranchThreshold();
+  return Max * Threshold.getDenominator() > Sum * Threshold.getNumerator();
+}
+
 /// isFormingBranchFromSelectProfitable - Returns true if a SelectInst should be
 /// turned into an explicit branch.
-static bool isFormingBranchFromSelectProfitable(SelectInst *SI) {
-  // FIXME: This should use the same heuristics as IfConversion to determine
-  // whether a select is better represented as a branch.  This requires that
-  // branch probability metadata is preserved for the select, which is not the
-  // case currently.
+static bool isFormingBranchFromSelectProfitable(const TargetLowering *TLI,
+                                                SelectInst *SI) {
+  // A heavily biased condition is predicted right nearly every time, so the
+  // branch costs less than the select's dependency on the condition.
+  if (hasPredictableProfile(SI, TLI))
+    return true;
 
   CmpInst *Cmp = dyn_cast<CmpInst>(SI->getCondition());
 
@@ -3891,9 +4276,11 @@ bool CodeGenPrepare::OptimizeSelectInst(SelectInst *SI) {
   // Do we have efficient codegen support for this kind of 'selects' ?
   if (TLI->isSelectSupported(SelectKind)) {
     // We have efficient codegen support for the select instruction.
-    // Check if it is profitable to keep this 'select'.
+    // Check if it is profitable to keep this 'select'. Selects that are
+    // marked unpredictable always are.
     if (!TLI->isPredictableSelectExpensive() ||
-        !isFormingBranchFromSelectProfitable(SI))
+        SI->getMetadata(LLVMContext::MD_unpredictable) ||
+        !isFormingBranchFromSelectProfitable(TLI, SI))
       return false;
   }
 
@@ -3913,8 +4300,13 @@ bool CodeGenPrepare::OptimizeSelectInst(SelectInst *SI) {
   StartBlock->getTerminator()->eraseFromParent();
   BranchInst::Create(NextBlock, SmallBlock);
 
-  // Insert the real conditional branch based on the original condition.
-  BranchInst::Create(NextBlock, SmallBlock, SI->getCondition(), SI);
+  // Insert the real conditional branch based on the original condition. It
+  // inherits the select's profile and predictability hints.
+  BranchInst *BI =
+      BranchInst::Create(NextBlock, SmallBlock, SI->getCondition(), SI);
+  for (unsigned Kind : {LLVMContext::MD_prof, LLVMContext::MD_unpredictable})
+    if (MDNode *MD = SI->getMetadata(Kind))
+      BI->setMetadata(Kind, MD);
 
   // The select itself is replaced with a PHI Node.
   PHINode *PN = PHINode::Create(SI->getType(), 2, "", NextBlock->begin());
@@ -4471,7 +4863,7 @@ bool CodeGenPrepare::OptimizeInst(Instruction *I, bool& ModifiedDT) {
 // across basic blocks and rewrite them to improve basic-block-at-a-time
 // selection.
 bool CodeGenPrepare::OptimizeBlock(BasicBlock &BB, bool& ModifiedDT) {
-  SunkAddrs.clear();
+  clearSunkAddrs();
   bool MadeChange = false;
 
   CurInstIterator = BB.begin();
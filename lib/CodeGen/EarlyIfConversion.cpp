@@ -30,10 +30,14 @@
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/MachineTraceMetrics.h"
 #include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetRegisterInfo.h"
 #include "llvm/Target/TargetSubtargetInfo.h"
 
@@ -595,11 +599,16 @@ class EarlyIfConverter : public MachineFunctionPass {
   MachineLoopInfo *Loops;
   MachineTraceMetrics *Traces;
   MachineTraceMetrics::Ensemble *MinInstr;
+  const MachineBranchProbabilityInfo *MBPI;
+  BranchProbability PredictableThreshold;
+  // Only convert branches marked unpredictable.
+  bool UnpredictableOnly;
   SSAIfConv IfConv;
 
 public:
   static char ID;
-  EarlyIfConverter() : MachineFunctionPass(ID) {}
+  EarlyIfConverter()
+      : MachineFunctionPass(ID), PredictableThreshold(99, 100) {}
   void getAnalysisUsage(AnalysisUsage &AU) const override;
   bool runOnMachineFunction(MachineFunction &MF) override;
   const char *getPassName() const override { return "Early If-Conversion"; }
@@ -609,6 +618,7 @@ private:
   void updateDomTree(ArrayRef<MachineBasicBlock*> Removed);
   void updateLoops(ArrayRef<MachineBasicBlock*> Removed);
   void invalidateTraces();
+  bool isPredictableBranch();
   bool shouldConvertIf();
 };
 } // end anonymous namespace
@@ -679,6 +689,35 @@ static unsigned adjCycles(unsigned Cyc, int Delta) {
   return Cyc + Delta;
 }
 
+/// Return true if the IR branch that \p MBB ends with is marked
+/// unpredictable. A block split during instruction selection shares its IR
+/// block's terminator, which is a close enough approximation.
+static bool isUnpredictableBranch(const MachineBasicBlock *MBB) {
+  const BasicBlock *BB = MBB->getBasicBlock();
+  if (!BB)
+    return false;
+  const TerminatorInst *TI = BB->getTerminator();
+  return TI && TI->getMetadata(LLVMContext::MD_unpredictable);
+}
+
+static bool hasUnpredictableBranch(const Function &F) {
+  for (const BasicBlock &BB : F)
+    if (const TerminatorInst *TI = BB.getTerminator())
+      if (TI->getMetadata(LLVMContext::MD_unpredictable))
+        return true;
+  return false;
+}
+
+/// Return true if the head branch is biased enough to be predicted right
+/// nearly every time, in which case it is cheaper than any select.
+bool EarlyIfConverter::isPredictableBranch() {
+  MachineBasicBlock *Head = IfConv.Head;
+  for (const MachineBasicBlock *Succ : Head->successors())
+    if (MBPI->getEdgeProbability(Head, Succ) > PredictableThreshold)
+      return true;
+  return false;
+}
+
 /// Apply cost model and heuristics to the if-conversion in IfConv.
 /// Return true if the conversion is a good idea.
 ///
@@ -687,6 +726,21 @@ bool EarlyIfConverter::shouldConvertIf() {
   if (Stress)
     return true;
 
+  // A mispredicted branch costs more than anything if-conversion could add
+  // to the critical path.
+  if (isUnpredictableBranch(IfConv.Head)) {
+    DEBUG(dbgs() << "Branch is unpredictable.\n");
+    return true;
+  }
+  if (UnpredictableOnly)
+    return false;
+
+  // Conversely, a well predicted branch is nearly free.
+  if (isPredictableBranch()) {
+    DEBUG(dbgs() << "Branch is predictable.\n");
+    return false;
+  }
+
   if (!MinInstr)
     MinInstr = Traces->getEnsemble(MachineTraceMetrics::TS_MinInstrCount);
 
@@ -787,7 +841,9 @@ bool EarlyIfConverter::runOnMachineFunction(MachineFunction &MF) {
                << "********** Function: " << MF.getName() << '\n');
   // Only run if conversion if the target wants it.
   const TargetSubtargetInfo &STI = MF.getSubtarget();
-  if (!STI.enableEarlyIfConversion())
+  UnpredictableOnly = !STI.enableEarlyIfConversion();
+  if (UnpredictableOnly && (!STI.enableEarlyIfConversionOfUnpredictable() ||
+                            !hasUnpredictableBranch(*MF.getFunction())))
     return false;
 
   TII = STI.getInstrInfo();
@@ -798,6 +854,9 @@ bool EarlyIfConverter::runOnMachineFunction(MachineFunction &MF) {
   Loops = getAnalysisIfAvailable<MachineLoopInfo>();
   Traces = &getAnalysis<MachineTraceMetrics>();
   MinInstr = nullptr;
+  MBPI = &getAnalysis<MachineBranchProbabilityInfo>();
+  PredictableThreshold =
+      STI.getTargetLowering()->getPredictableBranchThreshold();
 
   bool Changed = false;
   IfConv.runOnMachineFunction(MF);
@@ -0,0 +1,211 @@
+//===-- HotBlockAlignment.cpp - Align hot code to fetch windows -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass aligns the hottest loops and branch targets of a function to the
+// target's instruction fetch window (TargetLowering::getFetchAlignment) so
+// that they straddle as few windows as possible. Block placement only aligns
+// loops to the preferred loop alignment, which leaves whether a hot loop body
+// shares a fetch window or a decoded-uop cache line with its neighbours to
+// the luck of the surrounding code size, and that changes from build to build.
+//
+// The exact block offsets are not known until the code is assembled, so this
+// pass does not pad anything itself. It requests an alignment with a limit on
+// the padding (MachineBasicBlock::setPaddedAlignment) and the assembler only
+// emits the padding when it is cheap enough. The worst-case padding of all the
+// requests in a function is kept within a code-size budget, hottest blocks
+// first.
+//
+// By default only functions with profile data are considered: static
+// frequency estimates make every loop look hot.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetLowering.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+#include <algorithm>
+using namespace llvm;
+
+#define DEBUG_TYPE "hot-block-align"
+
+STATISTIC(NumLoopsAligned, "Number of hot loops aligned to a fetch window");
+STATISTIC(NumTargetsAligned,
+          "Number of hot branch targets aligned to a fetch window");
+STATISTIC(NumOverBudget, "Number of hot blocks left unaligned by the budget");
+
+static cl::opt<bool>
+EnableHotBlockAlign("hot-block-align", cl::Hidden, cl::init(true),
+                    cl::desc("Align hot blocks to the instruction fetch "
+                             "window"));
+
+static cl::opt<bool>
+HotBlockAlignStatic("hot-block-align-static", cl::Hidden, cl::init(false),
+                    cl::desc("Align hot blocks in functions without profile "
+                             "data, using estimated frequencies"));
+
+static cl::opt<unsigned>
+HotBlockFreqRatio("hot-block-align-freq-ratio", cl::Hidden, cl::init(8),
+                  cl::desc("Frequency, relative to the function entry, a "
+                           "block needs to be aligned to the fetch window"));
+
+static cl::opt<unsigned>
+BranchTargetMaxPadding("hot-block-align-target-max-padding", cl::Hidden,
+                       cl::init(8),
+                       cl::desc("Maximum padding in bytes in front of a hot "
+                                "branch target that is not a loop"));
+
+static cl::opt<unsigned>
+PaddingBudget("hot-block-align-budget", cl::Hidden, cl::init(64),
+              cl::desc("Maximum worst-case padding in bytes added to a "
+                       "function to align hot blocks"));
+
+namespace {
+class HotBlockAlignment : public MachineFunctionPass {
+  const MachineBlockFrequencyInfo *MBFI;
+  const MachineLoopInfo *MLI;
+
+  /// \brief A block worth aligning and how much padding it may take.
+  struct Candidate {
+    MachineBasicBlock *MBB;
+    BlockFrequency Freq;
+    unsigned MaxBytes;
+    bool IsLoop;
+  };
+
+  bool isLoopTop(const MachineBasicBlock &MBB) const;
+  bool isBranchTarget(const MachineBasicBlock &MBB) const;
+
+public:
+  static char ID; // Pass identification, replacement for typeid
+  HotBlockAlignment() : MachineFunctionPass(ID) {
+    initializeHotBlockAlignmentPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addRequired<MachineLoopInfo>();
+    AU.setPreservesAll();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+};
+}
+
+char HotBlockAlignment::ID = 0;
+char &llvm::HotBlockAlignmentID = HotBlockAlignment::ID;
+INITIALIZE_PASS_BEGIN(HotBlockAlignment, "hot-block-align",
+                      "Align hot blocks to fetch windows", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_END(HotBlockAlignment, "hot-block-align",
+                    "Align hot blocks to fetch windows", false, false)
+
+/// Return true if MBB is the first block, in layout order, of an innermost
+/// loop. That is where the back edge jumps to, so aligning it keeps the whole
+/// body in as few fetch windows as possible.
+bool HotBlockAlignment::isLoopTop(const MachineBasicBlock &MBB) const {
+  const MachineLoop *L = MLI->getLoopFor(&MBB);
+  if (!L || !L->empty())
+    return false;
+  const MachineBasicBlock *LayoutPred =
+      &*std::prev(MachineFunction::const_iterator(&MBB));
+  return !L->contains(LayoutPred);
+}
+
+/// Return true if MBB is only entered by jumps.
+bool HotBlockAlignment::isBranchTarget(const MachineBasicBlock &MBB) const {
+  if (MBB.pred_empty())
+    return false;
+  const MachineBasicBlock *LayoutPred =
+      &*std::prev(MachineFunction::const_iterator(&MBB));
+  return !LayoutPred->isSuccessor(&MBB);
+}
+
+bool HotBlockAlignment::runOnMachineFunction(MachineFunction &MF) {
+  if (!EnableHotBlockAlign || std::next(MF.begin()) == MF.end())
+    return false;
+
+  const Function *F = MF.getFunction();
+  if (skipOptnoneFunction(*F) || F->hasFnAttribute(Attribute::OptimizeForSize))
+    return false;
+  if (!HotBlockAlignStatic && !F->getEntryCount())
+    return false;
+
+  unsigned FetchAlign =
+      MF.getSubtarget().getTargetLowering()->getFetchAlignment();
+  if (!FetchAlign)
+    return false;
+
+  MBFI = &getAnalysis<MachineBlockFrequencyInfo>();
+  MLI = &getAnalysis<MachineLoopInfo>();
+
+  BlockFrequency HotFreq(MBFI->getBlockFreq(MF.begin()).getFrequency() *
+                        HotBlockFreqRatio);
+  SmallVector<Candidate, 8> Candidates;
+  for (MachineBasicBlock &MBB : MF) {
+    if (&MBB == MF.begin() || MBB.getAlignment() >= FetchAlign)
+      continue;
+    BlockFrequency Freq = MBFI->getBlockFreq(&MBB);
+    if (Freq < HotFreq)
+      continue;
+
+    // The padding never needs to be more than the distance between the
+    // block's own alignment and the fetch window.
+    unsigned MaxPadding = (1u << FetchAlign) - (1u << MBB.getAlignment());
+    if (isLoopTop(MBB))
+      Candidates.push_back({&MBB, Freq, MaxPadding, true});
+    else if (isBranchTarget(MBB) && BranchTargetMaxPadding)
+      Candidates.push_back(
+          {&MBB, Freq, std::min<unsigned>(MaxPadding, BranchTargetMaxPadding),
+           false});
+  }
+  if (Candidates.empty())
+    return false;
+
+  // Spend the budget on the hottest blocks first, loops before other branch
+  // targets of the same frequency.
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [](const Candidate &A, const Candidate &B) {
+    if (A.Freq.getFrequency() != B.Freq.getFrequency())
+      return B.Freq < A.Freq;
+    return A.IsLoop && !B.IsLoop;
+  });
+
+  unsigned Budget = PaddingBudget;
+  bool Changed = false;
+  for (const Candidate &C : Candidates) {
+    if (C.MaxBytes > Budget) {
+      ++NumOverBudget;
+      continue;
+    }
+    Budget -= C.MaxBytes;
+    DEBUG(dbgs() << "Aligning BB#" << C.MBB->getNumber() << " to "
+                 << (1u << FetchAlign) << " bytes, at most " << C.MaxBytes
+                 << " bytes of padding\n");
+    C.MBB->setPaddedAlignment(FetchAlign, C.MaxBytes);
+    if (C.IsLoop)
+      ++NumLoopsAligned;
+    else
+      ++NumTargetsAligned;
+    Changed = true;
+  }
+  return Changed;
+}
@@ -67,6 +67,10 @@ void LLVMTargetMachine::initAsmInfo() {
 
   if (Options.CompressDebugSections)
     TmpAsmInfo->setCompressDebugSections(true);
+  TmpAsmInfo->setCompressDebugSectionsFast(
+      Options.MCOptions.CompressDebugSectionsFast);
+  TmpAsmInfo->setCompressDebugSectionsThreads(
+      Options.MCOptions.CompressDebugSectionsThreads);
 
   AsmInfo = TmpAsmInfo;
 }
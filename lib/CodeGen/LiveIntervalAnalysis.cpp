@@ -19,6 +19,7 @@
 #include "LiveRangeCalc.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveVariables.h"
 #include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
@@ -44,6 +45,12 @@ using namespace llvm;
 
 #define DEBUG_TYPE "regalloc"
 
+STATISTIC(NumIntervalsCreated, "Number of live intervals created");
+STATISTIC(NumInitialSegments,
+          "Number of segments in the initially computed intervals");
+STATISTIC(NumInitialValNos,
+          "Number of value numbers in the initially computed intervals");
+
 char LiveIntervals::ID = 0;
 char &llvm::LiveIntervalsID = LiveIntervals::ID;
 INITIALIZE_PASS_BEGIN(LiveIntervals, "liveintervals",
@@ -103,8 +110,10 @@ LiveIntervals::~LiveIntervals() {
 void LiveIntervals::releaseMemory() {
   // Free the live intervals themselves.
   for (unsigned i = 0, e = VirtRegIntervals.size(); i != e; ++i)
-    delete VirtRegIntervals[TargetRegisterInfo::index2VirtReg(i)];
+    destroyInterval(VirtRegIntervals[TargetRegisterInfo::index2VirtReg(i)]);
   VirtRegIntervals.clear();
+  IntervalRecycler.clear(IntervalAllocator);
+  IntervalAllocator.Reset();
   RegMaskSlots.clear();
   RegMaskBits.clear();
   RegMaskBlocks.clear();
@@ -147,6 +156,17 @@ bool LiveIntervals::runOnMachineFunction(MachineFunction &fn) {
     for (unsigned i = 0, e = TRI->getNumRegUnits(); i != e; ++i)
       getRegUnit(i);
   }
+
+  if (AreStatisticsEnabled()) {
+    for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i) {
+      unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
+      if (!hasInterval(Reg))
+        continue;
+      const LiveInterval &LI = *VirtRegIntervals[Reg];
+      NumInitialSegments += LI.size();
+      NumInitialValNos += LI.getNumValNums();
+    }
+  }
   DEBUG(dump());
   return true;
 }
@@ -189,7 +209,16 @@ void LiveIntervals::dumpInstrs() const {
 LiveInterval* LiveIntervals::createInterval(unsigned reg) {
   float Weight = TargetRegisterInfo::isPhysicalRegister(reg) ?
                   llvm::huge_valf : 0.0F;
-  return new LiveInterval(reg, Weight);
+  ++NumIntervalsCreated;
+  return new (IntervalRecycler.Allocate(IntervalAllocator))
+      LiveInterval(reg, Weight);
+}
+
+void LiveIntervals::destroyInterval(LiveInterval *LI) {
+  if (!LI)
+    return;
+  LI->~LiveInterval();
+  IntervalRecycler.Deallocate(IntervalAllocator, LI);
 }
 
 
@@ -39,7 +39,8 @@ using namespace llvm;
 #define DEBUG_TYPE "codegen"
 
 MachineBasicBlock::MachineBasicBlock(MachineFunction &mf, const BasicBlock *bb)
-  : BB(bb), Number(-1), xParent(&mf), Alignment(0), IsLandingPad(false),
+  : BB(bb), Number(-1), xParent(&mf), Alignment(0),
+    PaddedAlignment(0), PaddedAlignmentMaxBytes(0), IsLandingPad(false),
     AddressTaken(false), CachedMCSymbol(nullptr) {
   Insts.Parent = this;
 }
@@ -273,9 +274,14 @@ void MachineBasicBlock::print(raw_ostream &OS, ModuleSlotTracker &MST,
   }
   if (isLandingPad()) { OS << Comma << "EH LANDING PAD"; Comma = ", "; }
   if (hasAddressTaken()) { OS << Comma << "ADDRESS TAKEN"; Comma = ", "; }
-  if (Alignment)
+  if (Alignment) {
     OS << Comma << "Align " << Alignment << " (" << (1u << Alignment)
        << " bytes)";
+    Comma = ", ";
+  }
+  if (PaddedAlignment)
+    OS << Comma << "Padded align " << PaddedAlignment << " (at most "
+       << PaddedAlignmentMaxBytes << " bytes of padding)";
 
   OS << '\n';
 
@@ -14,6 +14,7 @@
 
 #include "llvm/CodeGen/MachineScheduler.h"
 #include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/MachineDominators.h"
@@ -35,6 +36,8 @@ using namespace llvm;
 
 #define DEBUG_TYPE "misched"
 
+STATISTIC(NumRegionsCut, "Number of scheduling regions cut at the size limit");
+
 namespace llvm {
 cl::opt<bool> ForceTopDown("misched-topdown", cl::Hidden,
                            cl::desc("Force top-down list scheduling"));
@@ -76,6 +79,13 @@ static cl::opt<bool> EnableMacroFusion("misched-fusion", cl::Hidden,
 static cl::opt<bool> VerifyScheduling("verify-misched", cl::Hidden,
   cl::desc("Verify machine instrs before and after machine scheduling"));
 
+// Building and scheduling a DAG is superlinear in the size of the region, so
+// a single huge block can dominate compile time. Cutting such blocks into
+// regions of bounded size keeps the cost linear in the block size.
+static cl::opt<unsigned> RegionSizeLimit("misched-region-limit", cl::Hidden,
+  cl::desc("Cut scheduling regions after N instructions (0 = no limit)"),
+  cl::init(0));
+
 // DAG subtrees must have at least this many nodes.
 static const unsigned MinSubtreeSize = 8;
 
@@ -214,9 +224,8 @@ static cl::opt<bool> EnableMachineSched(
     cl::desc("Enable the machine instruction scheduling pass."), cl::init(true),
     cl::Hidden);
 
-/// Forward declare the standard machine scheduler. This will be used as the
-/// default scheduler if the target does not set a default.
-static ScheduleDAGInstrs *createGenericSchedLive(MachineSchedContext *C);
+/// Forward declare the standard postRA machine scheduler. This will be used as
+/// the default scheduler if the target does not set a default.
 static ScheduleDAGInstrs *createGenericSchedPostRA(MachineSchedContext *C);
 
 /// Decrement this iterator until reaching the top or a non-debug instr.
@@ -424,16 +433,20 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler) {
     // MBB::size() uses instr_iterator to count. Here we need a bundle to count
     // as a single instruction.
     unsigned RemainingInstrs = std::distance(MBB->begin(), MBB->end());
+    // Set when the previous region was cut at RegionSizeLimit rather than at
+    // a boundary instruction; the next region then ends right above it.
+    bool RegionWasCut = false;
     for(MachineBasicBlock::iterator RegionEnd = MBB->end();
         RegionEnd != MBB->begin(); RegionEnd = Scheduler.begin()) {
 
       // Avoid decrementing RegionEnd for blocks with no terminator.
-      if (RegionEnd != MBB->end() ||
-          isSchedBoundary(std::prev(RegionEnd), MBB, MF, TII, IsPostRA)) {
+      if (!RegionWasCut && (RegionEnd != MBB->end() ||
+          isSchedBoundary(std::prev(RegionEnd), MBB, MF, TII, IsPostRA))) {
         --RegionEnd;
         // Count the boundary instruction.
         --RemainingInstrs;
       }
+      RegionWasCut = false;
 
       // The next region starts above the previous region. Look backward in the
       // instruction stream until we find the nearest boundary.
@@ -442,6 +455,11 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler) {
       for(;I != MBB->begin(); --I, --RemainingInstrs) {
         if (isSchedBoundary(std::prev(I), MBB, MF, TII, IsPostRA))
           break;
+        if (RegionSizeLimit && NumRegionInstrs >= RegionSizeLimit) {
+          ++NumRegionsCut;
+          RegionWasCut = true;
+          break;
+        }
         if (!I->isDebugValue())
           ++NumRegionInstrs;
       }
@@ -2876,7 +2894,7 @@ void GenericScheduler::schedNode(SUnit *SU, bool IsTopNode) {
 
 /// Create the standard converging machine scheduler. This will be used as the
 /// default scheduler if the target does not set a default.
-static ScheduleDAGInstrs *createGenericSchedLive(MachineSchedContext *C) {
+ScheduleDAGMILive *llvm::createGenericSchedLive(MachineSchedContext *C) {
   ScheduleDAGMILive *DAG = new ScheduleDAGMILive(C, make_unique<GenericScheduler>(C));
   // Register DAG post-processors.
   //
@@ -2891,9 +2909,13 @@ static ScheduleDAGInstrs *createGenericSchedLive(MachineSchedContext *C) {
   return DAG;
 }
 
+static ScheduleDAGInstrs *createConvergingSched(MachineSchedContext *C) {
+  return createGenericSchedLive(C);
+}
+
 static MachineSchedRegistry
 GenericSchedRegistry("converge", "Standard converging scheduler.",
-                     createGenericSchedLive);
+                     createConvergingSched);
 
 //===----------------------------------------------------------------------===//
 // PostGenericScheduler - Generic PostRA implementation of MachineSchedStrategy.
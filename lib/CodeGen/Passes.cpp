@@ -800,4 +800,5 @@ void TargetPassConfig::addBlockPlacement() {
     if (EnableBlockPlacementStats)
       addPass(&MachineBlockPlacementStatsID);
   }
+  addPass(&HotBlockAlignmentID, false);
 }
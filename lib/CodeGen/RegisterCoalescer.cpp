@@ -52,6 +52,10 @@ STATISTIC(NumReMats   , "Number of instructions re-materialized");
 STATISTIC(NumInflated , "Number of register classes inflated");
 STATISTIC(NumLaneConflicts, "Number of dead lane conflicts tested");
 STATISTIC(NumLaneResolves,  "Number of dead lane conflicts resolved");
+STATISTIC(NumJoinsSkipped, "Number of repeated joins skipped because neither "
+                           "interval changed since they last failed");
+STATISTIC(NumLargeJoinsAbandoned, "Number of joins abandoned because a large "
+                                  "interval was joined too often");
 
 static cl::opt<bool>
 EnableJoining("join-liveintervals",
@@ -73,6 +77,16 @@ EnableGlobalCopies("join-globalcopies",
   cl::desc("Coalesce copies that span blocks (default=subtarget)"),
   cl::init(cl::BOU_UNSET), cl::Hidden);
 
+static cl::opt<unsigned> LargeIntervalSizeThreshold(
+    "large-interval-size-threshold", cl::Hidden, cl::init(100),
+    cl::desc("Number of value numbers above which an interval is considered "
+             "large by the coalescer"));
+
+static cl::opt<unsigned> LargeIntervalFreqThreshold(
+    "large-interval-freq-threshold", cl::Hidden, cl::init(100),
+    cl::desc("Number of joins tried on a large interval before the coalescer "
+             "stops coalescing it, to bound compile time"));
+
 static cl::opt<bool>
 VerifyCoalescing("verify-coalescing",
          cl::desc("Verify machine instrs before and after register coalescing"),
@@ -121,6 +135,42 @@ namespace {
     /// Virtual registers to be considered for register class inflation.
     SmallVector<unsigned, 8> InflateRegs;
 
+    /// Incremented whenever the live interval of a virtual register may have
+    /// changed. RegChangeStamp holds the value at the last change of each
+    /// register.
+    unsigned ChangeStamp;
+    DenseMap<unsigned, unsigned> RegChangeStamp;
+
+    /// A copy that could not be joined yet, with the registers it was tried
+    /// on, the other registers whose intervals the attempt looked at, and the
+    /// value of ChangeStamp at the time.
+    struct FailedJoin {
+      unsigned SrcReg, DstReg, Stamp;
+      SmallVector<unsigned, 4> ChainRegs;
+    };
+    DenseMap<MachineInstr*, FailedJoin> FailedJoins;
+
+    /// The registers, besides the two being joined, whose live intervals the
+    /// current join attempt read while following copy chains.
+    SmallVector<unsigned, 8> CopyChainRegs;
+
+    /// Number of joins tried on each large interval.
+    DenseMap<unsigned, unsigned> LargeLIVisitCounter;
+
+    /// Note that the live interval of Reg may have changed, so failed joins
+    /// involving it must be tried again.
+    void markRegChanged(unsigned Reg);
+
+    /// Return true if Copy already failed to join SrcReg and DstReg and
+    /// neither interval, nor any interval the attempt followed a copy chain
+    /// through, has changed since, so trying again is pointless.
+    bool isUnchangedFailedJoin(MachineInstr *Copy, unsigned SrcReg,
+                               unsigned DstReg) const;
+
+    /// Return true if LI is large and has already been joined often enough
+    /// that further attempts are not worth the compile time.
+    bool isHighCostLiveInterval(LiveInterval &LI);
+
     /// Recursively eliminate dead defs in DeadDefs.
     void eliminateDeadDefs();
 
@@ -472,6 +522,49 @@ void RegisterCoalescer::eliminateDeadDefs() {
 void RegisterCoalescer::LRE_WillEraseInstruction(MachineInstr *MI) {
   // MI may be in WorkList. Make sure we don't visit it.
   ErasedInstrs.insert(MI);
+  // The intervals of its operands are about to shrink.
+  for (const MachineOperand &MO : MI->operands())
+    if (MO.isReg() && TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      markRegChanged(MO.getReg());
+}
+
+void RegisterCoalescer::markRegChanged(unsigned Reg) {
+  RegChangeStamp[Reg] = ++ChangeStamp;
+}
+
+bool RegisterCoalescer::isUnchangedFailedJoin(MachineInstr *Copy,
+                                              unsigned SrcReg,
+                                              unsigned DstReg) const {
+  // Joins with physical registers also depend on the register unit live
+  // ranges, which are not tracked.
+  if (!TargetRegisterInfo::isVirtualRegister(SrcReg) ||
+      !TargetRegisterInfo::isVirtualRegister(DstReg))
+    return false;
+  auto I = FailedJoins.find(Copy);
+  if (I == FailedJoins.end())
+    return false;
+  const FailedJoin &FJ = I->second;
+  if (FJ.SrcReg != SrcReg || FJ.DstReg != DstReg ||
+      RegChangeStamp.lookup(SrcReg) > FJ.Stamp ||
+      RegChangeStamp.lookup(DstReg) > FJ.Stamp)
+    return false;
+  // Values that were copied from other registers were compared through
+  // those registers' intervals, so changes to them matter as well.
+  for (unsigned Reg : FJ.ChainRegs)
+    if (RegChangeStamp.lookup(Reg) > FJ.Stamp)
+      return false;
+  return true;
+}
+
+bool RegisterCoalescer::isHighCostLiveInterval(LiveInterval &LI) {
+  if (LI.getNumValNums() < LargeIntervalSizeThreshold)
+    return false;
+  unsigned &Counter = LargeLIVisitCounter[LI.reg];
+  if (Counter < LargeIntervalFreqThreshold) {
+    ++Counter;
+    return false;
+  }
+  return true;
 }
 
 bool RegisterCoalescer::adjustCopiesBackFrom(const CoalescerPair &CP,
@@ -1647,6 +1740,9 @@ class JoinVals {
   /// Values that will be present in the final live range.
   SmallVectorImpl<VNInfo*> &NewVNInfo;
 
+  /// Other registers whose live intervals followCopyChain has read.
+  SmallVectorImpl<unsigned> &ChainRegs;
+
   const CoalescerPair &CP;
   LiveIntervals *LIS;
   SlotIndexes *Indexes;
@@ -1791,11 +1887,11 @@ public:
   JoinVals(LiveRange &LR, unsigned Reg, unsigned SubIdx, unsigned LaneMask,
            SmallVectorImpl<VNInfo*> &newVNInfo, const CoalescerPair &cp,
            LiveIntervals *lis, const TargetRegisterInfo *TRI, bool SubRangeJoin,
-           bool TrackSubRegLiveness)
+           bool TrackSubRegLiveness, SmallVectorImpl<unsigned> &ChainRegs)
     : LR(LR), Reg(Reg), SubIdx(SubIdx), LaneMask(LaneMask),
       SubRangeJoin(SubRangeJoin), TrackSubRegLiveness(TrackSubRegLiveness),
-      NewVNInfo(newVNInfo), CP(cp), LIS(lis), Indexes(LIS->getSlotIndexes()),
-      TRI(TRI), Assignments(LR.getNumValNums(), -1), Vals(LR.getNumValNums())
+      NewVNInfo(newVNInfo), ChainRegs(ChainRegs), CP(cp), LIS(lis),
+      Indexes(LIS->getSlotIndexes()), TRI(TRI), Assignments(LR.getNumValNums(), -1), Vals(LR.getNumValNums())
   {}
 
   /// Analyze defs in LR and compute a value mapping in NewVNInfo.
@@ -1861,6 +1957,7 @@ std::pair<const VNInfo*, unsigned> JoinVals::followCopyChain(
       return std::make_pair(VNI, Reg);
 
     const LiveInterval &LI = LIS->getInterval(SrcReg);
+    ChainRegs.push_back(SrcReg);
     const VNInfo *ValueIn;
     // No subrange involved.
     if (!SubRangeJoin || !LI.hasSubRanges()) {
@@ -2474,9 +2571,9 @@ bool RegisterCoalescer::joinSubRegRanges(LiveRange &LRange, LiveRange &RRange,
                                          const CoalescerPair &CP) {
   SmallVector<VNInfo*, 16> NewVNInfo;
   JoinVals RHSVals(RRange, CP.getSrcReg(), CP.getSrcIdx(), LaneMask,
-                   NewVNInfo, CP, LIS, TRI, true, true);
+                   NewVNInfo, CP, LIS, TRI, true, true, CopyChainRegs);
   JoinVals LHSVals(LRange, CP.getDstReg(), CP.getDstIdx(), LaneMask,
-                   NewVNInfo, CP, LIS, TRI, true, true);
+                   NewVNInfo, CP, LIS, TRI, true, true, CopyChainRegs);
 
   // Compute NewVNInfo and resolve conflicts (see also joinVirtRegs())
   // We should be able to resolve all conflicts here as we could successfully do
@@ -2569,14 +2666,23 @@ bool RegisterCoalescer::joinVirtRegs(CoalescerPair &CP) {
   LiveInterval &LHS = LIS->getInterval(CP.getDstReg());
   bool TrackSubRegLiveness = MRI->shouldTrackSubRegLiveness(*CP.getNewRC());
   JoinVals RHSVals(RHS, CP.getSrcReg(), CP.getSrcIdx(), 0, NewVNInfo, CP, LIS,
-                   TRI, false, TrackSubRegLiveness);
+                   TRI, false, TrackSubRegLiveness, CopyChainRegs);
   JoinVals LHSVals(LHS, CP.getDstReg(), CP.getDstIdx(), 0, NewVNInfo, CP, LIS,
-                   TRI, false, TrackSubRegLiveness);
+                   TRI, false, TrackSubRegLiveness, CopyChainRegs);
 
   DEBUG(dbgs() << "\t\tRHS = " << RHS
                << "\n\t\tLHS = " << LHS
                << '\n');
 
+  // Joining two large intervals again and again dominates compile time in
+  // functions with long chains of copies. Past a budget, leave the copy to the
+  // register allocator.
+  if (isHighCostLiveInterval(LHS) || isHighCostLiveInterval(RHS)) {
+    DEBUG(dbgs() << "\t\tInterval too large, not joining.\n");
+    ++NumLargeJoinsAbandoned;
+    return false;
+  }
+
   // First compute NewVNInfo and the simple value mappings.
   // Detect impossible conflicts early.
   if (!LHSVals.mapValues(RHSVals) || !RHSVals.mapValues(LHSVals))
@@ -2661,8 +2767,11 @@ bool RegisterCoalescer::joinVirtRegs(CoalescerPair &CP) {
   SmallVector<unsigned, 8> ShrinkRegs;
   LHSVals.eraseInstrs(ErasedInstrs, ShrinkRegs);
   RHSVals.eraseInstrs(ErasedInstrs, ShrinkRegs);
-  while (!ShrinkRegs.empty())
-    shrinkToUses(&LIS->getInterval(ShrinkRegs.pop_back_val()));
+  while (!ShrinkRegs.empty()) {
+    unsigned Reg = ShrinkRegs.pop_back_val();
+    markRegChanged(Reg);
+    shrinkToUses(&LIS->getInterval(Reg));
+  }
 
   // Join RHS into LHS.
   LHS.join(RHS, LHSVals.getAssignments(), RHSVals.getAssignments(), NewVNInfo);
@@ -2755,8 +2864,35 @@ copyCoalesceWorkList(MutableArrayRef<MachineInstr*> CurrList) {
       CurrList[i] = nullptr;
       continue;
     }
+    MachineInstr *Copy = CurrList[i];
+    unsigned SrcReg = 0, DstReg = 0, SrcSubIdx, DstSubIdx;
+    isMoveInstr(*TRI, Copy, SrcReg, DstReg, SrcSubIdx, DstSubIdx);
+
     bool Again = false;
-    bool Success = joinCopy(CurrList[i], Again);
+    bool Success;
+    if (isUnchangedFailedJoin(Copy, SrcReg, DstReg)) {
+      ++NumJoinsSkipped;
+      Success = false;
+      Again = true;
+    } else {
+      CopyChainRegs.clear();
+      Success = joinCopy(Copy, Again);
+      if (Success) {
+        FailedJoins.erase(Copy);
+        markRegChanged(SrcReg);
+        markRegChanged(DstReg);
+      } else if (Again) {
+        FailedJoin &FJ = FailedJoins[Copy];
+        FJ.SrcReg = SrcReg;
+        FJ.DstReg = DstReg;
+        FJ.Stamp = ChangeStamp;
+        std::sort(CopyChainRegs.begin(), CopyChainRegs.end());
+        FJ.ChainRegs.clear();
+        FJ.ChainRegs.append(CopyChainRegs.begin(),
+                            std::unique(CopyChainRegs.begin(),
+                                        CopyChainRegs.end()));
+      }
+    }
     Progress |= Success;
     if (Success || !Again)
       CurrList[i] = nullptr;
@@ -2925,6 +3061,9 @@ void RegisterCoalescer::releaseMemory() {
   WorkList.clear();
   DeadDefs.clear();
   InflateRegs.clear();
+  RegChangeStamp.clear();
+  FailedJoins.clear();
+  LargeLIVisitCounter.clear();
 }
 
 bool RegisterCoalescer::runOnMachineFunction(MachineFunction &fn) {
@@ -2937,6 +3076,7 @@ bool RegisterCoalescer::runOnMachineFunction(MachineFunction &fn) {
   LIS = &getAnalysis<LiveIntervals>();
   AA = &getAnalysis<AliasAnalysis>();
   Loops = &getAnalysis<MachineLoopInfo>();
+  ChangeStamp = 0;
   if (EnableGlobalCopies == cl::BOU_UNSET)
     JoinGlobalCopies = STI.enableJoinGlobalCopies();
   else
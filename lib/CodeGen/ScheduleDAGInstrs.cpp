@@ -16,6 +16,7 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
@@ -49,6 +50,24 @@ static cl::opt<bool> EnableAASchedMI("enable-aa-sched-mi", cl::Hidden,
 static cl::opt<bool> UseTBAA("use-tbaa-in-sched-mi", cl::Hidden,
     cl::init(true), cl::desc("Enable use of TBAA during MI DAG construction"));
 
+// Every memory access is checked against the accesses below it that are still
+// tracked for its underlying objects, so blocks with thousands of memory
+// accesses build a quadratic number of chain edges. Once this many accesses
+// are tracked, the lowest ones are put behind a barrier node instead.
+static cl::opt<unsigned> HugeRegion("dag-maps-huge-region", cl::Hidden,
+    cl::init(1000), cl::desc("The number of tracked memory nodes at which "
+                             "DAG construction trades precision for compile "
+                             "time (0 = no limit)"));
+
+static cl::opt<unsigned> ReductionSize("dag-maps-reduction-size", cl::Hidden,
+    cl::desc("The number of memory nodes a huge region drops at a time. "
+             "Defaults to dag-maps-huge-region / 2."));
+
+STATISTIC(NumDAGsBuilt, "Number of scheduling DAGs built");
+STATISTIC(NumChainDeps, "Number of memory chain dependencies");
+STATISTIC(NumMemNodeReductions, "Number of times memory node maps were "
+                                "reduced in huge regions");
+
 ScheduleDAGInstrs::ScheduleDAGInstrs(MachineFunction &mf,
                                      const MachineLoopInfo *mli,
                                      bool IsPostRAFlag, bool RemoveKillFlags,
@@ -685,6 +704,102 @@ static inline void addChainDependency(AliasAnalysis *AA,
   }
 }
 
+typedef MapVector<ValueType, std::vector<SUnit *> > Value2SUsMap;
+
+/// Return the number of memory nodes tracked in \p Map.
+static unsigned countMemNodes(const Value2SUsMap &Map) {
+  unsigned NumNodes = 0;
+  for (const auto &I : Map)
+    NumNodes += I.second.size();
+  return NumNodes;
+}
+
+/// Stop tracking the nodes of \p SUs that are not above \p BarrierChain. The
+/// ones below it are made to depend on it; as every memory node seen from now
+/// on depends on BarrierChain, they stay ordered after those.
+static void insertBarrierChain(std::vector<SUnit *> &SUs,
+                               SUnit *BarrierChain) {
+  SUs.erase(std::remove_if(SUs.begin(), SUs.end(),
+                           [&](SUnit *SU) {
+                             if (SU->NodeNum < BarrierChain->NodeNum)
+                               return false;
+                             if (SU != BarrierChain)
+                               SU->addPred(SDep(BarrierChain, SDep::Barrier));
+                             return true;
+                           }),
+            SUs.end());
+}
+
+/// Reduce the memory nodes tracked while building the DAG of a huge region.
+/// The \p N lowest nodes, i.e. those seen first, are dropped from all maps
+/// and lists; the topmost of them becomes the new BarrierChain.
+static void reduceHugeMemNodeMaps(ArrayRef<Value2SUsMap *> Maps,
+                                  std::vector<SUnit *> &PendingLoads,
+                                  std::set<SUnit *> &RejectMemNodes,
+                                  SUnit *&BarrierChain, unsigned N) {
+  std::vector<unsigned> NodeNums;
+  for (Value2SUsMap *Map : Maps)
+    for (const auto &I : *Map)
+      for (SUnit *SU : I.second)
+        NodeNums.push_back(SU->NodeNum);
+  for (SUnit *SU : PendingLoads)
+    NodeNums.push_back(SU->NodeNum);
+  std::sort(NodeNums.begin(), NodeNums.end());
+  NodeNums.erase(std::unique(NodeNums.begin(), NodeNums.end()),
+                 NodeNums.end());
+  N = std::min<unsigned>(N, NodeNums.size());
+  if (!N)
+    return;
+
+  // SUnits are numbered top-down while the DAG is built bottom-up, so the
+  // nodes seen first have the highest numbers.
+  SUnit *NewBarrierChain = nullptr;
+  for (Value2SUsMap *Map : Maps)
+    for (const auto &I : *Map)
+      for (SUnit *SU : I.second)
+        if (SU->NodeNum == NodeNums[NodeNums.size() - N])
+          NewBarrierChain = SU;
+  for (SUnit *SU : PendingLoads)
+    if (SU->NodeNum == NodeNums[NodeNums.size() - N])
+      NewBarrierChain = SU;
+  assert(NewBarrierChain && "Lost the new barrier chain");
+
+  // All tracked nodes are above the current barrier chain, so link it
+  // behind the new one.
+  if (BarrierChain) {
+    assert(NewBarrierChain->NodeNum < BarrierChain->NodeNum &&
+           "Tracked memory node below the barrier chain");
+    BarrierChain->addPred(SDep(NewBarrierChain, SDep::Barrier));
+  }
+  BarrierChain = NewBarrierChain;
+
+  for (Value2SUsMap *Map : Maps) {
+    for (auto &I : *Map)
+      insertBarrierChain(I.second, BarrierChain);
+    Map->remove_if([](const std::pair<ValueType, std::vector<SUnit *> > &I) {
+      return I.second.empty();
+    });
+  }
+  insertBarrierChain(PendingLoads, BarrierChain);
+  for (auto I = RejectMemNodes.begin(), E = RejectMemNodes.end(); I != E;) {
+    if ((*I)->NodeNum >= BarrierChain->NodeNum)
+      I = RejectMemNodes.erase(I);
+    else
+      ++I;
+  }
+  ++NumMemNodeReductions;
+}
+
+/// Return the number of memory and barrier chain edges in \p SUnits.
+static unsigned countChainDeps(const std::vector<SUnit> &SUnits) {
+  unsigned NumDeps = 0;
+  for (const SUnit &SU : SUnits)
+    for (const SDep &Pred : SU.Preds)
+      if (Pred.isNormalMemoryOrBarrier())
+        ++NumDeps;
+  return NumDeps;
+}
+
 /// Create an SUnit for each real instruction, numbered in top-down toplological
 /// order. The instruction order A < B, implies that no edge exists from B to A.
 ///
@@ -776,6 +891,11 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
   MapVector<ValueType, std::vector<SUnit *> > AliasMemDefs, NonAliasMemDefs;
   MapVector<ValueType, std::vector<SUnit *> > AliasMemUses, NonAliasMemUses;
   std::set<SUnit*> RejectMemNodes;
+  Value2SUsMap *MemNodeMaps[] = {&AliasMemDefs, &NonAliasMemDefs,
+                                 &AliasMemUses, &NonAliasMemUses};
+  // An upper bound of the number of nodes in the maps and PendingLoads. It
+  // is only made exact when it reaches HugeRegion.
+  unsigned NumMemNodes = 0;
 
   // Remove any stale debug info; sometimes BuildSchedGraph is called again
   // without emitting the info from the previous call.
@@ -979,6 +1099,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
             NonAliasMemDefs[V].push_back(SU);
           }
         }
+        ++NumMemNodes;
         // Handle the uses in MemUses, if there are any.
         MapVector<ValueType, std::vector<SUnit *> >::iterator J =
           ((ThisMayAlias) ? AliasMemUses.find(V) : NonAliasMemUses.find(V));
@@ -1024,6 +1145,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
                                  I->second[i], RejectMemNodes);
 
           PendingLoads.push_back(SU);
+          ++NumMemNodes;
           MayAlias = true;
         } else {
           MayAlias = false;
@@ -1050,6 +1172,7 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
             AliasMemUses[V].push_back(SU);
           else
             NonAliasMemUses[V].push_back(SU);
+          ++NumMemNodes;
         }
         if (MayAlias)
           adjustChainDeps(AA, MFI, *TM.getDataLayout(), SU, &ExitSU,
@@ -1062,10 +1185,34 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
           BarrierChain->addPred(SDep(SU, SDep::Barrier));
       }
     }
+
+    // Keep the number of tracked memory nodes, and with it the number of
+    // chain edges per memory access, bounded in huge regions.
+    if (HugeRegion && NumMemNodes >= HugeRegion) {
+      NumMemNodes = PendingLoads.size();
+      for (Value2SUsMap *Map : MemNodeMaps)
+        NumMemNodes += countMemNodes(*Map);
+      if (NumMemNodes >= HugeRegion) {
+        DEBUG(dbgs() << "Reducing " << NumMemNodes << " memory nodes at SU("
+                     << SU->NodeNum << ")\n");
+        unsigned N = ReductionSize ? ReductionSize : HugeRegion / 2;
+        reduceHugeMemNodeMaps(MemNodeMaps, PendingLoads, RejectMemNodes,
+                              BarrierChain, std::max(N, 1U));
+        NumMemNodes = PendingLoads.size();
+        for (Value2SUsMap *Map : MemNodeMaps)
+          NumMemNodes += countMemNodes(*Map);
+      }
+    }
   }
   if (DbgMI)
     FirstDbgValue = DbgMI;
 
+  ++NumDAGsBuilt;
+  if (AreStatisticsEnabled())
+    NumChainDeps += countChainDeps(SUnits);
+  DEBUG(dbgs() << "Memory chain dependencies: " << countChainDeps(SUnits)
+               << " for " << SUnits.size() << " SUnits\n");
+
   Defs.clear();
   Uses.clear();
   VRegDefs.clear();
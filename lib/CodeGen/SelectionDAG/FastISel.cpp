@@ -1239,11 +1239,55 @@ bool FastISel::selectIntrinsicCall(const IntrinsicInst *II) {
   case Intrinsic::experimental_patchpoint_void:
   case Intrinsic::experimental_patchpoint_i64:
     return selectPatchpoint(II);
+  // Assumptions and annotations are dropped during selection.
+  case Intrinsic::assume:
+  case Intrinsic::var_annotation:
+    return true;
+  // Try the target's patterns for the bit manipulation intrinsics before
+  // handing them to the target hook. The zero-is-undef flag of ctlz and cttz
+  // only widens the set of valid results, so it can be ignored.
+  case Intrinsic::bswap:
+    if (selectUnaryIntrinsic(II, ISD::BSWAP))
+      return true;
+    break;
+  case Intrinsic::ctpop:
+    if (selectUnaryIntrinsic(II, ISD::CTPOP))
+      return true;
+    break;
+  case Intrinsic::ctlz:
+    if (selectUnaryIntrinsic(II, ISD::CTLZ))
+      return true;
+    break;
+  case Intrinsic::cttz:
+    if (selectUnaryIntrinsic(II, ISD::CTTZ))
+      return true;
+    break;
   }
 
   return fastLowerIntrinsicCall(II);
 }
 
+bool FastISel::selectUnaryIntrinsic(const IntrinsicInst *II,
+                                    unsigned ISDOpcode) {
+  EVT VT = TLI.getValueType(II->getType(), /*AllowUnknown=*/true);
+  if (VT == MVT::Other || !VT.isSimple() || !TLI.isTypeLegal(VT))
+    return false;
+
+  const Value *Op0 = II->getArgOperand(0);
+  unsigned Op0Reg = getRegForValue(Op0);
+  if (!Op0Reg)
+    return false;
+  bool Op0IsKill = hasTrivialKill(Op0);
+
+  unsigned ResultReg = fastEmit_r(VT.getSimpleVT(), VT.getSimpleVT(),
+                                  ISDOpcode, Op0Reg, Op0IsKill);
+  if (!ResultReg)
+    return false;
+
+  updateValueMap(II, ResultReg);
+  return true;
+}
+
 bool FastISel::selectCast(const User *I, unsigned Opcode) {
   EVT SrcVT = TLI.getValueType(I->getOperand(0)->getType());
   EVT DstVT = TLI.getValueType(I->getType());
@@ -163,6 +163,14 @@ STATISTIC(NumFastIselFailFrameaddress, "Fast isel fails on Frameaddress");
 STATISTIC(NumFastIselFailSqrt, "Fast isel fails on sqrt call");
 STATISTIC(NumFastIselFailStackMap, "Fast isel fails on StackMap call");
 STATISTIC(NumFastIselFailPatchPoint, "Fast isel fails on PatchPoint call");
+STATISTIC(NumFastIselFailMemCpy, "Fast isel fails on memcpy");
+STATISTIC(NumFastIselFailMemMove, "Fast isel fails on memmove");
+STATISTIC(NumFastIselFailMemSet, "Fast isel fails on memset");
+STATISTIC(NumFastIselFailFAbs, "Fast isel fails on fabs");
+STATISTIC(NumFastIselFailBSwap, "Fast isel fails on bswap");
+STATISTIC(NumFastIselFailCtPop, "Fast isel fails on ctpop");
+STATISTIC(NumFastIselFailCtlz, "Fast isel fails on ctlz");
+STATISTIC(NumFastIselFailCttz, "Fast isel fails on cttz");
 #endif
 
 static cl::opt<bool>
@@ -1088,6 +1096,22 @@ static void collectFailStats(const Instruction *I) {
       case Intrinsic::experimental_patchpoint_void: // fall-through
       case Intrinsic::experimental_patchpoint_i64:
         NumFastIselFailPatchPoint++; return;
+      case Intrinsic::memcpy:
+        NumFastIselFailMemCpy++; return;
+      case Intrinsic::memmove:
+        NumFastIselFailMemMove++; return;
+      case Intrinsic::memset:
+        NumFastIselFailMemSet++; return;
+      case Intrinsic::fabs:
+        NumFastIselFailFAbs++; return;
+      case Intrinsic::bswap:
+        NumFastIselFailBSwap++; return;
+      case Intrinsic::ctpop:
+        NumFastIselFailCtPop++; return;
+      case Intrinsic::ctlz:
+        NumFastIselFailCtlz++; return;
+      case Intrinsic::cttz:
+        NumFastIselFailCttz++; return;
       }
     }
     NumFastIselFailCall++;
@@ -1228,7 +1252,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         }
 
 #ifndef NDEBUG
-        if (EnableFastISelVerbose2)
+        if (EnableFastISelVerbose2 || AreStatisticsEnabled())
           collectFailStats(Inst);
 #endif
 
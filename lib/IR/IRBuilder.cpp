@@ -235,6 +235,50 @@ CallInst *IRBuilderBase::CreateMaskedStore(Value *Val, Value *Ptr,
   return CreateMaskedIntrinsic(Intrinsic::masked_store, Ops, Val->getType());
 }
 
+/// Create a call to a Masked Gather intrinsic.
+/// Ptrs     - vector of pointers for loading
+/// Align    - alignment for one element
+/// Mask     - vector of booleans which indicates what vector lanes should
+///            be accessed in memory; all lanes are accessed when null
+/// PassThru - a pass-through value that is used to fill the masked-off lanes
+///            of the result
+/// Name     - name of the result variable
+CallInst *IRBuilderBase::CreateMaskedGather(Value *Ptrs, unsigned Align,
+                                            Value *Mask, Value *PassThru,
+                                            const Twine &Name) {
+  VectorType *PtrsTy = cast<VectorType>(Ptrs->getType());
+  unsigned NumElts = PtrsTy->getVectorNumElements();
+  Type *DataTy = VectorType::get(
+      cast<PointerType>(PtrsTy->getElementType())->getElementType(), NumElts);
+
+  if (!Mask)
+    Mask = Constant::getAllOnesValue(VectorType::get(getInt1Ty(), NumElts));
+  if (!PassThru)
+    PassThru = UndefValue::get(DataTy);
+
+  Value *Ops[] = { Ptrs, getInt32(Align), Mask, PassThru };
+  // The data type is the only overloaded type
+  return CreateMaskedIntrinsic(Intrinsic::masked_gather, Ops, DataTy, Name);
+}
+
+/// Create a call to a Masked Scatter intrinsic.
+/// Val   - the data to be stored
+/// Ptrs  - the vector of pointers, where the Val elements should be stored
+/// Align - alignment for one element
+/// Mask  - vector of booleans which indicates what vector lanes should
+///         be accessed in memory; all lanes are accessed when null
+CallInst *IRBuilderBase::CreateMaskedScatter(Value *Val, Value *Ptrs,
+                                             unsigned Align, Value *Mask) {
+  unsigned NumElts = Val->getType()->getVectorNumElements();
+  if (!Mask)
+    Mask = Constant::getAllOnesValue(VectorType::get(getInt1Ty(), NumElts));
+
+  Value *Ops[] = { Val, Ptrs, getInt32(Align), Mask };
+  // The data type is the only overloaded type
+  return CreateMaskedIntrinsic(Intrinsic::masked_scatter, Ops,
+                               Val->getType());
+}
+
 /// Create a call to a Masked intrinsic, with given intrinsic Id,
 /// an array of operands - Ops, and one overloaded type - DataTy
 CallInst *IRBuilderBase::CreateMaskedIntrinsic(Intrinsic::ID Id,
@@ -38,18 +38,52 @@ PassRegistry *PassRegistry::getPassRegistry() {
 
 PassRegistry::~PassRegistry() {}
 
-const PassInfo *PassRegistry::getPassInfo(const void *TI) const {
+const PassInfo *PassRegistry::findPassInfo(const void *TI) const {
   sys::SmartScopedReader<true> Guard(Lock);
   MapType::const_iterator I = PassInfoMap.find(TI);
   return I != PassInfoMap.end() ? I->second : nullptr;
 }
 
-const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
+const PassInfo *PassRegistry::findPassInfo(StringRef Arg) const {
   sys::SmartScopedReader<true> Guard(Lock);
   StringMapType::const_iterator I = PassInfoStringMap.find(Arg);
   return I != PassInfoStringMap.end() ? I->second : nullptr;
 }
 
+const PassInfo *PassRegistry::getPassInfo(const void *TI) const {
+  if (const PassInfo *PI = findPassInfo(TI))
+    return PI;
+  return runDeferredInitializers() ? findPassInfo(TI) : nullptr;
+}
+
+const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
+  if (const PassInfo *PI = findPassInfo(Arg))
+    return PI;
+  return runDeferredInitializers() ? findPassInfo(Arg) : nullptr;
+}
+
+//===----------------------------------------------------------------------===//
+// Deferred initialization
+//
+
+void PassRegistry::addDeferredInitializer(void (*Init)(PassRegistry &)) {
+  sys::SmartScopedWriter<true> Guard(Lock);
+  DeferredInitializers.push_back(Init);
+}
+
+bool PassRegistry::runDeferredInitializers() const {
+  // The initializers register passes, which takes the lock, so run them
+  // without holding it.
+  std::vector<void (*)(PassRegistry &)> Pending;
+  {
+    sys::SmartScopedWriter<true> Guard(Lock);
+    Pending.swap(DeferredInitializers);
+  }
+  for (auto *Init : Pending)
+    Init(const_cast<PassRegistry &>(*this));
+  return !Pending.empty();
+}
+
 //===----------------------------------------------------------------------===//
 // Pass Registration mechanism
 //
@@ -81,7 +115,9 @@ void PassRegistry::registerAnalysisGroup(const void *InterfaceID,
                                          const void *PassID,
                                          PassInfo &Registeree, bool isDefault,
                                          bool ShouldFree) {
-  PassInfo *InterfaceInfo = const_cast<PassInfo *>(getPassInfo(InterfaceID));
+  // Not finding the interface is expected here, so don't run the deferred
+  // initializers over it.
+  PassInfo *InterfaceInfo = const_cast<PassInfo *>(findPassInfo(InterfaceID));
   if (!InterfaceInfo) {
     // First reference to Interface, register it now.
     registerPass(Registeree);
@@ -91,7 +127,8 @@ void PassRegistry::registerAnalysisGroup(const void *InterfaceID,
          "Trying to join an analysis group that is a normal pass!");
 
   if (PassID) {
-    PassInfo *ImplementationInfo = const_cast<PassInfo *>(getPassInfo(PassID));
+    PassInfo *ImplementationInfo =
+        const_cast<PassInfo *>(findPassInfo(PassID));
     assert(ImplementationInfo &&
            "Must register pass before adding to AnalysisGroup!");
 
@@ -37,6 +37,7 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -228,20 +229,20 @@ bool LTOCodeGenerator::compileOptimizedToFile(const char **name,
     return false;
   }
 
-  // generate object file
-  tool_output_file objFile(Filename.c_str(), FD);
-
-  bool genResult = compileOptimized(objFile.os(), errMsg);
-  objFile.os().close();
-  if (objFile.os().has_error()) {
-    objFile.os().clear_error();
+  // generate object file straight into a mapped file: a big object would
+  // otherwise be written with many small writes and seeks.
+  raw_file_buffer_ostream objFile(FD, Filename, EC);
+  if (EC) {
+    errMsg = EC.message();
     sys::fs::remove(Twine(Filename));
     return false;
   }
 
-  objFile.keep();
-  if (!genResult) {
-    sys::fs::remove(Twine(Filename));
+  if (!compileOptimized(objFile, errMsg))
+    return false;
+  EC = objFile.commit();
+  if (EC) {
+    errMsg = EC.message();
     return false;
   }
 
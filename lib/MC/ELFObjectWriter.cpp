@@ -957,10 +957,16 @@ ELFObjectWriter::createRelocationSection(MCContext &Ctx,
   return RelaSection;
 }
 
-static SmallVector<char, 128>
+// Size of the blocks a debug_* section is cut into when it is compressed on
+// several threads.
+static const size_t DebugCompressionBlockSize = 256 * 1024;
+
+// Collect the contents of all the fragments of a debug_* section. The
+// returned references point into the fragments, nothing is copied.
+static SmallVector<StringRef, 16>
 getUncompressedData(const MCAsmLayout &Layout,
                     const MCSection::FragmentListType &Fragments) {
-  SmallVector<char, 128> UncompressedData;
+  SmallVector<StringRef, 16> UncompressedData;
   for (const MCFragment &F : Fragments) {
     const SmallVectorImpl<char> *Contents;
     switch (F.getKind()) {
@@ -977,7 +983,7 @@ getUncompressedData(const MCAsmLayout &Layout,
       llvm_unreachable(
           "Not expecting any other fragment types in a debug_* section");
     }
-    UncompressedData.append(Contents->begin(), Contents->end());
+    UncompressedData.push_back(StringRef(Contents->data(), Contents->size()));
   }
   return UncompressedData;
 }
@@ -1018,19 +1024,31 @@ void ELFObjectWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
 
   // Gather the uncompressed data from all the fragments.
   const MCSection::FragmentListType &Fragments = Section.getFragmentList();
-  SmallVector<char, 128> UncompressedData =
+  SmallVector<StringRef, 16> UncompressedData =
       getUncompressedData(Layout, Fragments);
-
+  uint64_t UncompressedSize = 0;
+  for (StringRef Data : UncompressedData)
+    UncompressedSize += Data.size();
+
+  // With a single thread, compress the section as one block; this gives the
+  // same bytes as a plain zlib::compress. Otherwise deflate blocks of the
+  // section in parallel.
+  const MCAsmInfo *MAI = Asm.getContext().getAsmInfo();
+  unsigned Threads = MAI->compressDebugSectionsThreads();
+  size_t BlockSize = Threads == 1 ? std::max<uint64_t>(UncompressedSize, 1)
+                                  : DebugCompressionBlockSize;
   SmallVector<char, 128> CompressedContents;
-  zlib::Status Success = zlib::compress(
-      StringRef(UncompressedData.data(), UncompressedData.size()),
-      CompressedContents);
+  zlib::Status Success = zlib::compressChunked(
+      UncompressedData, CompressedContents,
+      MAI->compressDebugSectionsFast() ? zlib::BestSpeedCompression
+                                       : zlib::DefaultCompression,
+      Threads, BlockSize);
   if (Success != zlib::StatusOK) {
     Asm.writeSectionData(&Section, Layout);
     return;
   }
 
-  if (!prependCompressionHeader(UncompressedData.size(), CompressedContents)) {
+  if (!prependCompressionHeader(UncompressedSize, CompressedContents)) {
     Asm.writeSectionData(&Section, Layout);
     return;
   }
@@ -108,6 +108,8 @@ MCAsmInfo::MCAsmInfo() {
   UseIntegratedAssembler = false;
 
   CompressDebugSections = false;
+  CompressDebugSectionsFast = false;
+  CompressDebugSectionsThreads = 1;
 }
 
 MCAsmInfo::~MCAsmInfo() {
@@ -16,7 +16,8 @@ MCTargetOptions::MCTargetOptions()
     : SanitizeAddress(false), MCRelaxAll(false), MCNoExecStack(false),
       MCFatalWarnings(false), MCSaveTempLabels(false),
       MCUseDwarfDirectory(false), ShowMCEncoding(false), ShowMCInst(false),
-      AsmVerbose(false), DwarfVersion(0), ABIName() {}
+      AsmVerbose(false), CompressDebugSectionsFast(false), DwarfVersion(0),
+      CompressDebugSectionsThreads(1), ABIName() {}
 
 StringRef MCTargetOptions::getABIName() const {
   return ABIName;
@@ -108,7 +108,13 @@ public:
   void ParseCommandLineOptions(int argc, const char *const *argv,
                                const char *Overview);
 
+  /// Add the options constructed since the last call to the maps, in the
+  /// order they were constructed. This must be called before looking at any
+  /// of the option maps.
+  void addPendingOptions();
+
   void addLiteralOption(Option &Opt, const char *Name) {
+    addPendingOptions();
     if (!Opt.hasArgStr()) {
       if (!OptionsMap.insert(std::make_pair(Name, &Opt)).second) {
         errs() << ProgramName << ": CommandLine Error: Option '" << Name
@@ -151,6 +157,7 @@ public:
   }
 
   void removeOption(Option *O) {
+    addPendingOptions();
     SmallVector<const char *, 16> OptionNames;
     O->getExtraOptionNames(OptionNames);
     if (O->ArgStr[0])
@@ -183,6 +190,7 @@ public:
   }
 
   void updateArgStr(Option *O, const char *NewName) {
+    addPendingOptions();
     if (!OptionsMap.insert(std::make_pair(NewName, O)).second) {
       errs() << ProgramName << ": CommandLine Error: Option '" << O->ArgStr
              << "' registered more than once!\n";
@@ -212,6 +220,31 @@ private:
 
 static ManagedStatic<CommandLineParser> GlobalParser;
 
+// Options are not added to the parser as they are constructed, which mostly
+// happens in static constructors: hashing hundreds of names into the option
+// map is a measurable part of the startup time of every tool, and most
+// processes never look an option up. Instead they are pushed on this list and
+// added the first time the parser is used. It is a plain pointer so that it is
+// constant initialized, before any option's constructor runs.
+static Option *PendingOptions = nullptr;
+
+void CommandLineParser::addPendingOptions() {
+  if (!PendingOptions)
+    return;
+
+  // The list is in reverse construction order, and positional arguments are
+  // matched in construction order.
+  SmallVector<Option *, 64> Pending;
+  for (Option *O = PendingOptions; O; O = O->NextPending)
+    Pending.push_back(O);
+  PendingOptions = nullptr;
+  while (!Pending.empty()) {
+    Option *O = Pending.pop_back_val();
+    O->NextPending = nullptr;
+    addOption(O);
+  }
+}
+
 void cl::AddLiteralOption(Option &O, const char *Name) {
   GlobalParser->addLiteralOption(O, Name);
 }
@@ -221,11 +254,20 @@ extrahelp::extrahelp(const char *Help) : morehelp(Help) {
 }
 
 void Option::addArgument() {
-  GlobalParser->addOption(this);
+  NextPending = PendingOptions;
+  PendingOptions = this;
   FullyInitialized = true;
 }
 
-void Option::removeArgument() { GlobalParser->removeOption(this); }
+void Option::removeArgument() {
+  for (Option **Link = &PendingOptions; *Link; Link = &(*Link)->NextPending)
+    if (*Link == this) {
+      *Link = NextPending;
+      NextPending = nullptr;
+      return;
+    }
+  GlobalParser->removeOption(this);
+}
 
 void Option::setArgStr(const char *S) {
   if (FullyInitialized)
@@ -248,6 +290,10 @@ void OptionCategory::registerCategory() {
 /// command line.  If there is a value specified (after an equal sign) return
 /// that as well.  This assumes that leading dashes have already been stripped.
 Option *CommandLineParser::LookupOption(StringRef &Arg, StringRef &Value) {
+  // Handling an earlier argument may have constructed options, e.g. -load
+  // runs the constructors of a plugin's options.
+  addPendingOptions();
+
   // Reject all dashes.
   if (Arg.empty())
     return nullptr;
@@ -817,6 +863,7 @@ void cl::ParseCommandLineOptions(int argc, const char *const *argv,
 void CommandLineParser::ParseCommandLineOptions(int argc,
                                                 const char *const *argv,
                                                 const char *Overview) {
+  addPendingOptions();
   assert(hasOptions() && "No options specified!");
 
   // Expand response files.
@@ -1499,6 +1546,7 @@ public:
     if (!Value)
       return;
 
+    GlobalParser->addPendingOptions();
     StrOptionPairVector Opts;
     sortOpts(GlobalParser->OptionsMap, Opts, ShowHidden);
 
@@ -1720,6 +1768,8 @@ void CommandLineParser::printOptionValues() {
   if (!PrintOptions && !PrintAllOptions)
     return;
 
+  addPendingOptions();
+
   SmallVector<std::pair<const char *, Option *>, 128> Opts;
   sortOpts(OptionsMap, Opts, /*ShowHidden*/ true);
 
@@ -1830,10 +1880,12 @@ void cl::AddExtraVersionPrinter(void (*func)()) {
 }
 
 StringMap<Option *> &cl::getRegisteredOptions() {
+  GlobalParser->addPendingOptions();
   return GlobalParser->OptionsMap;
 }
 
 void cl::HideUnrelatedOptions(cl::OptionCategory &Category) {
+  GlobalParser->addPendingOptions();
   for (auto &I : GlobalParser->OptionsMap) {
     if (I.second->Category != &Category &&
         I.second->Category != &GenericCategory)
@@ -1844,6 +1896,7 @@ void cl::HideUnrelatedOptions(cl::OptionCategory &Category) {
 void cl::HideUnrelatedOptions(ArrayRef<const cl::OptionCategory *> Categories) {
   auto CategoriesBegin = Categories.begin();
   auto CategoriesEnd = Categories.end();
+  GlobalParser->addPendingOptions();
   for (auto &I : GlobalParser->OptionsMap) {
     if (std::find(CategoriesBegin, CategoriesEnd, I.second->Category) ==
             CategoriesEnd &&
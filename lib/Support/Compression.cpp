@@ -12,11 +12,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Compression.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
+#include <cstring>
+#include <thread>
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -62,6 +66,176 @@ zlib::Status zlib::compress(StringRef InputBuffer,
   return Res;
 }
 
+namespace {
+/// One independently deflated piece of a chunked stream.
+struct CompressionBlock {
+  /// The input of this block; slices of the caller's buffers.
+  SmallVector<StringRef, 4> Pieces;
+  bool Last;
+  int Result;
+  uLong Adler;
+  uLong Size;
+  SmallVector<char, 0> Output;
+
+  CompressionBlock()
+      : Last(false), Result(Z_OK), Adler(0), Size(0) {}
+};
+}
+
+// Largest LZ77 window deflate can reference, used to prime each block.
+static const size_t DeflateWindowSize = 32 * 1024;
+
+/// Run deflate on the current input until it is consumed and, if \p Flush is
+/// not Z_NO_FLUSH, all pending output has been produced. \p Out grows as
+/// needed.
+static int deflateAll(z_stream &Strm, SmallVectorImpl<char> &Out, int Flush) {
+  while (true) {
+    if (Strm.avail_out == 0) {
+      size_t Used = Out.size();
+      Out.resize(Used + std::max<size_t>(Used / 2, 4096));
+      Strm.next_out = (Bytef *)Out.data() + Used;
+      Strm.avail_out = Out.size() - Used;
+    }
+    int Res = ::deflate(&Strm, Flush);
+    if (Res == Z_STREAM_END)
+      return Z_OK;
+    if (Res != Z_OK && Res != Z_BUF_ERROR)
+      return Res;
+    if (Flush == Z_FINISH || Strm.avail_in != 0)
+      continue;
+    // A flush is complete once deflate stops short of filling the output.
+    if (Flush == Z_NO_FLUSH || Strm.avail_out != 0)
+      return Z_OK;
+  }
+}
+
+static void compressBlock(MutableArrayRef<CompressionBlock> Blocks,
+                          unsigned Idx, int CLevel) {
+  CompressionBlock &B = Blocks[Idx];
+  B.Adler = ::adler32(0, Z_NULL, 0);
+  B.Size = 0;
+
+  z_stream Strm;
+  std::memset(&Strm, 0, sizeof(Strm));
+  // Negative window bits request a raw deflate stream; the zlib header and
+  // trailer are written once for the whole stream by compressChunked.
+  B.Result = ::deflateInit2(&Strm, CLevel, Z_DEFLATED, -15, 8,
+                            Z_DEFAULT_STRATEGY);
+  if (B.Result != Z_OK)
+    return;
+
+  // Prime the dictionary with the input preceding this block so the
+  // compression ratio does not suffer from the block boundaries.
+  if (Idx != 0) {
+    SmallVector<StringRef, 4> Tail;
+    size_t Need = DeflateWindowSize;
+    for (unsigned I = Idx; I-- != 0 && Need;) {
+      ArrayRef<StringRef> Pieces = Blocks[I].Pieces;
+      for (auto P = Pieces.rbegin(), E = Pieces.rend(); P != E && Need; ++P) {
+        Tail.push_back(P->size() > Need ? P->substr(P->size() - Need) : *P);
+        Need -= Tail.back().size();
+      }
+    }
+    SmallVector<char, 0> Dict;
+    for (auto P = Tail.rbegin(), E = Tail.rend(); P != E; ++P)
+      Dict.append(P->begin(), P->end());
+    B.Result = ::deflateSetDictionary(&Strm, (const Bytef *)Dict.data(),
+                                      Dict.size());
+    if (B.Result != Z_OK) {
+      ::deflateEnd(&Strm);
+      return;
+    }
+  }
+
+  // Start from a typical compression ratio for debug info and let deflateAll
+  // grow the buffer, rather than reserving the worst case for every block.
+  size_t InSize = 0;
+  for (StringRef P : B.Pieces)
+    InSize += P.size();
+  B.Output.resize(InSize / 4 + 64);
+  Strm.next_out = (Bytef *)B.Output.data();
+  Strm.avail_out = B.Output.size();
+  int EndFlush = B.Last ? Z_FINISH : Z_SYNC_FLUSH;
+  for (size_t I = 0, E = B.Pieces.size(); I != E; ++I) {
+    StringRef P = B.Pieces[I];
+    B.Adler = ::adler32(B.Adler, (const Bytef *)P.data(), P.size());
+    B.Size += P.size();
+    Strm.next_in = (Bytef *)P.data();
+    Strm.avail_in = P.size();
+    B.Result = deflateAll(Strm, B.Output, I + 1 == E ? EndFlush : Z_NO_FLUSH);
+    if (B.Result != Z_OK)
+      break;
+  }
+  if (B.Pieces.empty())
+    B.Result = deflateAll(Strm, B.Output, EndFlush);
+  B.Output.resize(B.Output.size() - Strm.avail_out);
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented ZLib.
+  __msan_unpoison(B.Output.data(), B.Output.size());
+  ::deflateEnd(&Strm);
+}
+
+zlib::Status zlib::compressChunked(ArrayRef<StringRef> Inputs,
+                                   SmallVectorImpl<char> &CompressedBuffer,
+                                   CompressionLevel Level, unsigned Threads,
+                                   size_t BlockSize) {
+  assert(BlockSize && "Cannot compress into empty blocks!");
+
+  // Cut the inputs into blocks without copying them.
+  SmallVector<CompressionBlock, 8> Blocks(1);
+  size_t Used = 0;
+  for (StringRef In : Inputs) {
+    while (!In.empty()) {
+      if (Used == BlockSize) {
+        Blocks.emplace_back();
+        Used = 0;
+      }
+      size_t Take = std::min(In.size(), BlockSize - Used);
+      Blocks.back().Pieces.push_back(In.substr(0, Take));
+      In = In.substr(Take);
+      Used += Take;
+    }
+  }
+  Blocks.back().Last = true;
+
+  int CLevel = encodeZlibCompressionLevel(Level);
+  MutableArrayRef<CompressionBlock> BlockRef(Blocks);
+  if (Blocks.size() == 1 || Threads == 1) {
+    for (unsigned I = 0, E = Blocks.size(); I != E; ++I)
+      compressBlock(BlockRef, I, CLevel);
+  } else {
+    if (!Threads)
+      Threads = std::thread::hardware_concurrency();
+    ThreadPool Pool(std::min<size_t>(Threads, Blocks.size()));
+    for (unsigned I = 0, E = Blocks.size(); I != E; ++I)
+      Pool.async([=] { compressBlock(BlockRef, I, CLevel); });
+    Pool.wait();
+  }
+
+  // Stitch the blocks together between a zlib header and trailer. The header
+  // matches what compress2 writes for the same level.
+  CompressedBuffer.clear();
+  unsigned char CMF = 0x78; // Deflate with a 32K window.
+  unsigned char FLevel = 2;
+  if (CLevel != Z_DEFAULT_COMPRESSION)
+    FLevel = CLevel < 2 ? 0 : CLevel < 6 ? 1 : CLevel == 6 ? 2 : 3;
+  unsigned char FLG = FLevel << 6;
+  FLG += 31 - (CMF * 256 + FLG) % 31;
+  CompressedBuffer.push_back(CMF);
+  CompressedBuffer.push_back(FLG);
+
+  uLong Adler = ::adler32(0, Z_NULL, 0);
+  for (const CompressionBlock &B : Blocks) {
+    if (B.Result != Z_OK)
+      return encodeZlibReturnValue(B.Result);
+    CompressedBuffer.append(B.Output.begin(), B.Output.end());
+    Adler = ::adler32_combine(Adler, B.Adler, B.Size);
+  }
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back((Adler >> Shift) & 0xff);
+  return StatusOK;
+}
+
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
@@ -87,6 +261,12 @@ zlib::Status zlib::compress(StringRef InputBuffer,
                             CompressionLevel Level) {
   return zlib::StatusUnsupported;
 }
+zlib::Status zlib::compressChunked(ArrayRef<StringRef> Inputs,
+                                   SmallVectorImpl<char> &CompressedBuffer,
+                                   CompressionLevel Level, unsigned Threads,
+                                   size_t BlockSize) {
+  return zlib::StatusUnsupported;
+}
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
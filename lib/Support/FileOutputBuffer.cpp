@@ -15,6 +15,8 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Errc.h"
+#include <algorithm>
+#include <cstring>
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -31,7 +33,8 @@ FileOutputBuffer::FileOutputBuffer(std::unique_ptr<mapped_file_region> R,
     : Region(std::move(R)), FinalPath(Path), TempPath(TmpPath) {}
 
 FileOutputBuffer::~FileOutputBuffer() {
-  sys::fs::remove(Twine(TempPath));
+  if (!TempPath.empty())
+    sys::fs::remove(Twine(TempPath));
 }
 
 std::error_code
@@ -101,12 +104,189 @@ FileOutputBuffer::create(StringRef FilePath, size_t Size,
   return std::error_code();
 }
 
-std::error_code FileOutputBuffer::commit() {
+std::error_code
+FileOutputBuffer::create(int FD, StringRef FilePath, size_t Size,
+                         std::unique_ptr<FileOutputBuffer> &Result) {
+  std::error_code EC;
+#ifndef LLVM_ON_WIN32
+  // See above for why this isn't needed on Windows.
+  EC = sys::fs::resize_file(FD, Size);
+  if (EC) {
+    close(FD);
+    return EC;
+  }
+#endif
+
+  auto MappedFile = llvm::make_unique<mapped_file_region>(
+      FD, mapped_file_region::readwrite, Size, 0, EC);
+  int Ret = close(FD);
+  if (EC)
+    return EC;
+  if (Ret)
+    return std::error_code(errno, std::generic_category());
+
+  // The file is written in place: it is its own temporary file.
+  Result.reset(new FileOutputBuffer(std::move(MappedFile), FilePath, FilePath));
+  return std::error_code();
+}
+
+std::error_code FileOutputBuffer::grow(size_t NewSize) {
+  assert(NewSize >= getBufferSize() && "Cannot shrink a FileOutputBuffer");
+
+  // Unmap the buffer. Its content stays in the temporary file, which is
+  // extended and mapped again.
+  Region.reset();
+
+  int FD;
+  std::error_code EC = sys::fs::openFileForWrite(
+      Twine(TempPath), FD, sys::fs::F_RW | sys::fs::F_Append);
+  if (EC)
+    return EC;
+
+#ifndef LLVM_ON_WIN32
+  // See create() for why this isn't needed on Windows.
+  EC = sys::fs::resize_file(FD, NewSize);
+  if (EC) {
+    close(FD);
+    return EC;
+  }
+#endif
+
+  auto MappedFile = llvm::make_unique<mapped_file_region>(
+      FD, mapped_file_region::readwrite, NewSize, 0, EC);
+  int Ret = close(FD);
+  if (EC)
+    return EC;
+  if (Ret)
+    return std::error_code(errno, std::generic_category());
+
+  Region = std::move(MappedFile);
+  return std::error_code();
+}
+
+std::error_code FileOutputBuffer::commit(int64_t NewSmallerSize) {
   // Unmap buffer, letting OS flush dirty pages to file on disk.
   Region.reset();
 
+  // If requested, resize file as part of commit.
+  if (NewSmallerSize != -1) {
+    int FD;
+    std::error_code EC = sys::fs::openFileForWrite(
+        Twine(TempPath), FD, sys::fs::F_RW | sys::fs::F_Append);
+    if (EC)
+      return EC;
+    EC = sys::fs::resize_file(FD, NewSmallerSize);
+    int Ret = close(FD);
+    if (EC)
+      return EC;
+    if (Ret)
+      return std::error_code(errno, std::generic_category());
+  }
 
   // Rename file to final name.
-  return sys::fs::rename(Twine(TempPath), Twine(FinalPath));
+  if (TempPath != FinalPath)
+    if (std::error_code EC = sys::fs::rename(Twine(TempPath), Twine(FinalPath)))
+      return EC;
+  // The file is no longer ours to delete.
+  TempPath.clear();
+  return std::error_code();
+}
+
+//===----------------------------------------------------------------------===//
+//  raw_file_buffer_ostream
+//===----------------------------------------------------------------------===//
+
+raw_file_buffer_ostream::raw_file_buffer_ostream(StringRef Path,
+                                                 std::error_code &EC,
+                                                 size_t SizeHint,
+                                                 unsigned Flags)
+    : raw_pwrite_stream(/*Unbuffered=*/true), Pos(0) {
+  // An empty file cannot be mapped.
+  EC = FileOutputBuffer::create(Path, std::max<size_t>(SizeHint, 1), Buffer,
+                                Flags);
+  if (EC) {
+    this->EC = EC;
+    return;
+  }
+  SetBuffer(reinterpret_cast<char *>(Buffer->getBufferStart()),
+            Buffer->getBufferSize());
+}
+
+raw_file_buffer_ostream::raw_file_buffer_ostream(int FD, StringRef Path,
+                                                 std::error_code &EC,
+                                                 size_t SizeHint)
+    : raw_pwrite_stream(/*Unbuffered=*/true), Pos(0) {
+  EC = FileOutputBuffer::create(FD, Path, std::max<size_t>(SizeHint, 1),
+                                Buffer);
+  if (EC) {
+    this->EC = EC;
+    return;
+  }
+  SetBuffer(reinterpret_cast<char *>(Buffer->getBufferStart()),
+            Buffer->getBufferSize());
+}
+
+raw_file_buffer_ostream::~raw_file_buffer_ostream() {
+  // Uncommitted output is discarded with the file buffer.
+  if (Buffer)
+    SetUnbuffered();
+}
+
+bool raw_file_buffer_ostream::reserve(uint64_t Size) {
+  uint64_t Capacity = Buffer->getBufferSize();
+  if (Size <= Capacity)
+    return true;
+
+  // Grow geometrically so that remapping is rare.
+  if (std::error_code GrowEC = Buffer->grow(std::max(Size, Capacity * 2))) {
+    EC = GrowEC;
+    Buffer.reset();
+    SetUnbuffered();
+    return false;
+  }
+  return true;
+}
+
+void raw_file_buffer_ostream::write_impl(const char *Ptr, size_t Size) {
+  if (!Buffer)
+    return;
+
+  // Data that was written into the stream's buffer is already in place; data
+  // written around it has to be copied.
+  char *Start = reinterpret_cast<char *>(Buffer->getBufferStart());
+  if (Ptr != Start + Pos) {
+    assert(!GetNumBytesInBuffer());
+    if (!reserve(Pos + Size))
+      return;
+    Start = reinterpret_cast<char *>(Buffer->getBufferStart());
+    memcpy(Start + Pos, Ptr, Size);
+  }
+  Pos += Size;
+
+  // The stream's buffer must not be empty.
+  if (!reserve(Pos + 1))
+    return;
+  Start = reinterpret_cast<char *>(Buffer->getBufferStart());
+  SetBuffer(Start + Pos, Buffer->getBufferSize() - Pos);
+}
+
+void raw_file_buffer_ostream::pwrite_impl(const char *Ptr, size_t Size,
+                                          uint64_t Offset) {
+  if (!Buffer)
+    return;
+  assert(Offset + Size <= Pos + GetNumBytesInBuffer() &&
+         "We don't support extending the stream");
+  memcpy(Buffer->getBufferStart() + Offset, Ptr, Size);
+}
+
+std::error_code raw_file_buffer_ostream::commit() {
+  if (!Buffer)
+    return EC;
+  flush();
+  uint64_t Size = Pos;
+  SetUnbuffered();
+  EC = Buffer->commit(Size);
+  Buffer.reset();
+  return EC;
 }
 } // namespace
@@ -370,6 +370,16 @@ StringRef sys::getHostCPUName() {
       case 61:
         return "broadwell";
 
+      // Skylake client parts lack AVX-512, which our "skylake" implies.
+      case 78:
+      case 94:
+        return "broadwell";
+
+      // Skylake Server:
+      case 85:
+        // Only use the AVX-512 model if the OS saves the extended state.
+        return HasAVX512 ? "skx" : "broadwell";
+
       case 28: // Most 45 nm Intel Atom processors
       case 38: // 45 nm Atom Lincroft
       case 39: // 32 nm Atom Medfield
@@ -494,6 +504,13 @@ StringRef sys::getHostCPUName() {
         if (!HasAVX) // If the OS doesn't support AVX provide a sane fallback.
           return "btver1";
         return "btver2";
+      case 23:
+        // Without OS support for AVX there is no fitting AMD CPU: btver1 would
+        // tune for a low power core and turn off SSSE3 and SSE4. Use generic
+        // tuning and leave the ISA to the host features.
+        if (!HasAVX)
+          return "generic";
+        return "znver1";
     default:
       return "generic";
     }
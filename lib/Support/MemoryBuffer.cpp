@@ -14,6 +14,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/config.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Errno.h"
 #include "llvm/Support/FileSystem.h"
@@ -21,6 +22,8 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstring>
@@ -170,6 +173,74 @@ MemoryBuffer::getFileOrSTDIN(const Twine &Filename, int64_t FileSize) {
   return getFile(Filename, FileSize);
 }
 
+/// Read \p Filename, or stdin for "-", into memory. Unlike getFileOrSTDIN this
+/// never maps the file, so that the I/O really happens on the calling thread
+/// rather than when the consumer first touches the pages.
+static ErrorOr<std::unique_ptr<MemoryBuffer>>
+readFileOrSTDIN(const std::string &Filename) {
+  if (Filename == "-")
+    return MemoryBuffer::getSTDIN();
+  return MemoryBuffer::getFile(Filename, -1, /*RequiresNullTerminator=*/true,
+                               /*IsVolatileSize=*/true);
+}
+
+void MemoryBuffer::getFilesOrSTDIN(
+    ArrayRef<std::string> Filenames,
+    function_ref<void(size_t, ErrorOr<std::unique_ptr<MemoryBuffer>>)> Callback,
+    unsigned ThreadCount) {
+#if LLVM_ENABLE_THREADS
+  if (Filenames.size() > 1) {
+    typedef ErrorOr<std::unique_ptr<MemoryBuffer>> ResultTy;
+    // Results[I] is set by a worker once file I has been read and cleared
+    // again once it has been handed to Callback.
+    std::vector<std::unique_ptr<ResultTy>> Results(Filenames.size());
+    std::mutex ResultsLock;
+    std::condition_variable ResultReady;
+
+    if (!ThreadCount)
+      ThreadCount = std::thread::hardware_concurrency();
+    ThreadCount = std::max(1u, ThreadCount);
+    ThreadPool Pool(std::min<size_t>(ThreadCount, Filenames.size()));
+
+    // Reads are only queued a few files ahead of the callback, so a slow
+    // consumer never has more than MaxInFlight buffers in memory at once.
+    size_t MaxInFlight = 2 * size_t(ThreadCount);
+    size_t NumQueued = 0;
+    auto QueueUpTo = [&](size_t End) {
+      for (End = std::min(End, Filenames.size()); NumQueued < End;
+           ++NumQueued) {
+        size_t I = NumQueued;
+        Pool.async([&, I] {
+          std::unique_ptr<ResultTy> Result(
+              new ResultTy(readFileOrSTDIN(Filenames[I])));
+          {
+            std::lock_guard<std::mutex> Guard(ResultsLock);
+            Results[I] = std::move(Result);
+          }
+          ResultReady.notify_one();
+        });
+      }
+    };
+
+    for (size_t I = 0, E = Filenames.size(); I != E; ++I) {
+      QueueUpTo(I + MaxInFlight);
+      std::unique_ptr<ResultTy> Result;
+      {
+        std::unique_lock<std::mutex> Guard(ResultsLock);
+        ResultReady.wait(Guard, [&] { return Results[I] != nullptr; });
+        Result = std::move(Results[I]);
+      }
+      Callback(I, std::move(*Result));
+    }
+    Pool.wait();
+    return;
+  }
+#endif
+
+  for (size_t I = 0, E = Filenames.size(); I != E; ++I)
+    Callback(I, readFileOrSTDIN(Filenames[I]));
+}
+
 ErrorOr<std::unique_ptr<MemoryBuffer>>
 MemoryBuffer::getFileSlice(const Twine &FilePath, uint64_t MapSize, 
                            uint64_t Offset) {
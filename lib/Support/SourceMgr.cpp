@@ -19,27 +19,39 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
 using namespace llvm;
 
 static const size_t TabStop = 8;
 
-namespace {
-  struct LineNoCacheTy {
-    unsigned LastQueryBufferID;
-    const char *LastQuery;
-    unsigned LineNoOfQuery;
-  };
-}
-
-static LineNoCacheTy *getCache(void *Ptr) {
-  return (LineNoCacheTy*)Ptr;
-}
-
+unsigned SourceMgr::SrcBuffer::getLineNumber(const char *Ptr) const {
+  const char *BufStart = Buffer->getBufferStart();
+  size_t Offset = Ptr - BufStart;
+
+  // The offsets in the index are 32 bits. Count the lines of a bigger buffer
+  // the slow way.
+  if (Buffer->getBufferSize() > UINT32_MAX)
+    return 1 + std::count(BufStart, Ptr, '\n');
+
+  // Index the newlines up to the location if that part of the buffer hasn't
+  // been looked at yet. This makes diagnostics that come out in order cost
+  // one pass over the buffer, and the others a binary search. memchr is much
+  // faster than looking at one character at a time.
+  if (Offset > NewlinesIndexedTo) {
+    const char *Cur = BufStart + NewlinesIndexedTo;
+    while (const char *NL = static_cast<const char *>(
+               memchr(Cur, '\n', Ptr - Cur))) {
+      NewlineOffsets.push_back(NL - BufStart);
+      Cur = NL + 1;
+    }
+    NewlinesIndexedTo = Offset;
+  }
 
-SourceMgr::~SourceMgr() {
-  // Delete the line # cache if allocated.
-  if (LineNoCacheTy *Cache = getCache(LineNoCache))
-    delete Cache;
+  // The line number is one more than the number of newlines before Ptr.
+  return 1 + (std::lower_bound(NewlineOffsets.begin(), NewlineOffsets.end(),
+                               Offset) -
+              NewlineOffsets.begin());
 }
 
 unsigned SourceMgr::AddIncludeFile(const std::string &Filename,
@@ -79,40 +91,12 @@ SourceMgr::getLineAndColumn(SMLoc Loc, unsigned BufferID) const {
     BufferID = FindBufferContainingLoc(Loc);
   assert(BufferID && "Invalid Location!");
 
-  const MemoryBuffer *Buff = getMemoryBuffer(BufferID);
+  const SrcBuffer &SB = getBufferInfo(BufferID);
+  const char *BufStart = SB.Buffer->getBufferStart();
+  const char *Ptr = Loc.getPointer();
 
-  // Count the number of \n's between the start of the file and the specified
-  // location.
-  unsigned LineNo = 1;
+  unsigned LineNo = SB.getLineNumber(Ptr);
 
-  const char *BufStart = Buff->getBufferStart();
-  const char *Ptr = BufStart;
-
-  // If we have a line number cache, and if the query is to a later point in the
-  // same file, start searching from the last query location.  This optimizes
-  // for the case when multiple diagnostics come out of one file in order.
-  if (LineNoCacheTy *Cache = getCache(LineNoCache))
-    if (Cache->LastQueryBufferID == BufferID &&
-        Cache->LastQuery <= Loc.getPointer()) {
-      Ptr = Cache->LastQuery;
-      LineNo = Cache->LineNoOfQuery;
-    }
-
-  // Scan for the location being queried, keeping track of the number of lines
-  // we see.
-  for (; SMLoc::getFromPointer(Ptr) != Loc; ++Ptr)
-    if (*Ptr == '\n') ++LineNo;
-
-  // Allocate the line number cache if it doesn't exist.
-  if (!LineNoCache)
-    LineNoCache = new LineNoCacheTy();
-
-  // Update the line # cache.
-  LineNoCacheTy &Cache = *getCache(LineNoCache);
-  Cache.LastQueryBufferID = BufferID;
-  Cache.LastQuery = Ptr;
-  Cache.LineNoOfQuery = LineNo;
-  
   size_t NewlineOffs = StringRef(BufStart, Ptr-BufStart).find_last_of("\n\r");
   if (NewlineOffs == StringRef::npos) NewlineOffs = ~(size_t)0;
   return std::make_pair(LineNo, Ptr-BufStart-NewlineOffs);
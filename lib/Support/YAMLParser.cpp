@@ -139,8 +139,9 @@ struct Token : ilist_node<Token> {
   /// of the token in the input.
   StringRef Range;
 
-  /// The value of a block scalar node.
-  std::string Value;
+  /// The value of a block scalar node. It is allocated along with the token
+  /// in the token queue, so it must be copied before the token is consumed.
+  StringRef Value;
 
   Token() : Kind(TK_Error) {}
 };
@@ -1643,7 +1644,7 @@ bool Scanner::scanBlockScalar(bool IsLiteral) {
   Token T;
   T.Kind = Token::TK_BlockScalar;
   T.Range = StringRef(Start, Current - Start);
-  T.Value = Str.str().str();
+  T.Value = Str.str().copy(TokenQueue.Alloc);
   TokenQueue.push_back(T);
   return true;
 }
@@ -2378,9 +2379,11 @@ parse_property:
                 , TagInfo.Range
                 , T.Range);
   case Token::TK_BlockScalar: {
+    char *Buf = NodeAllocator.Allocate<char>(T.Value.size() + 1);
+    memcpy(Buf, T.Value.data(), T.Value.size());
+    Buf[T.Value.size()] = '\0';
+    StringRef StrCopy(Buf, T.Value.size());
     getNext();
-    StringRef NullTerminatedStr(T.Value.c_str(), T.Value.length() + 1);
-    StringRef StrCopy = NullTerminatedStr.copy(NodeAllocator).drop_back();
     return new (NodeAllocator)
         BlockScalarNode(stream.CurrentDoc, AnchorInfo.Range.substr(1),
                         TagInfo.Range, StrCopy, T.Range);
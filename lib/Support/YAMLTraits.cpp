@@ -18,6 +18,7 @@
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cctype>
+#include <climits>
 #include <cstring>
 using namespace llvm;
 using namespace yaml;
@@ -50,7 +51,8 @@ Input::Input(StringRef InputContent,
              void *DiagHandlerCtxt)
   : IO(Ctxt),
     Strm(new Stream(InputContent, SrcMgr)),
-    CurrentNode(nullptr) {
+    CurrentNode(nullptr),
+    Streaming(false) {
   if (DiagHandler)
     SrcMgr.setDiagHandler(DiagHandler, DiagHandlerCtxt);
   DocIterator = Strm->begin();
@@ -86,7 +88,7 @@ bool Input::setCurrentDocument() {
       ++DocIterator;
       return setCurrentDocument();
     }
-    TopNode = this->createHNodes(N);
+    TopNode = Streaming ? createStreamingHNode(N) : createHNodes(N);
     CurrentNode = TopNode.get();
     return true;
   }
@@ -94,6 +96,10 @@ bool Input::setCurrentDocument() {
 }
 
 bool Input::nextDocument() {
+  if (TopNode && !EC)
+    skipUnread(TopNode.get());
+  TopNode.reset();
+  CurrentNode = nullptr;
   return ++DocIterator != Strm->end();
 }
 
@@ -141,7 +147,10 @@ bool Input::preflightKey(const char *Key, bool Required, bool, bool &UseDefault,
     return false;
   }
   MN->ValidKeys.push_back(Key);
-  HNode *Value = MN->Mapping[Key].get();
+  HNode *Value =
+      MN->IsStreaming ? readMapEntry(MN, Key) : MN->Mapping[Key].get();
+  if (EC)
+    return false;
   if (!Value) {
     if (Required)
       setError(CurrentNode, Twine("missing required key '") + Key + "'");
@@ -156,6 +165,9 @@ bool Input::preflightKey(const char *Key, bool Required, bool, bool &UseDefault,
 
 void Input::postflightKey(void *saveInfo) {
   CurrentNode = reinterpret_cast<HNode *>(saveInfo);
+  MapHNode *MN = cast<MapHNode>(CurrentNode);
+  if (MN->IsStreaming)
+    finishMapEntry(MN);
 }
 
 void Input::endMapping() {
@@ -165,6 +177,23 @@ void Input::endMapping() {
   MapHNode *MN = dyn_cast_or_null<MapHNode>(CurrentNode);
   if (!MN)
     return;
+  if (MN->IsStreaming) {
+    // Check the keys that were not asked for without building their values.
+    finishMapEntry(MN);
+    if (!MN->Started) {
+      MN->Started = true;
+      MN->Next = cast<MappingNode>(MN->_node)->begin();
+    }
+    for (; MN->Next != MappingNode::iterator(); ++MN->Next) {
+      StringRef Key;
+      if (!readKey(*MN->Next, Key))
+        return;
+      if (!MN->isValidKey(Key)) {
+        setError(MN->Next->getValue(), Twine("unknown key '") + Key + "'");
+        return;
+      }
+    }
+  }
   for (const auto &NN : MN->Mapping) {
     if (!MN->isValidKey(NN.first())) {
       setError(NN.second.get(), Twine("unknown key '") + NN.first() + "'");
@@ -178,8 +207,17 @@ void Input::beginFlowMapping() { beginMapping(); }
 void Input::endFlowMapping() { endMapping(); }
 
 unsigned Input::beginSequence() {
-  if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode))
-    return SQ->Entries.size();
+  if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
+    if (!SQ->IsStreaming)
+      return SQ->Entries.size();
+    if (SQ->Started) {
+      setError(CurrentNode, "sequence can only be read once in streaming mode");
+      return 0;
+    }
+    // The number of elements is not known until they have all been read,
+    // preflightElement() returns false after the last one.
+    return UINT_MAX;
+  }
   if (isa<EmptyHNode>(CurrentNode))
     return 0;
   // Treat case where there's a scalar "null" value as an empty sequence.
@@ -193,14 +231,20 @@ unsigned Input::beginSequence() {
 }
 
 void Input::endSequence() {
+  if (!EC && CurrentNode)
+    skipUnread(CurrentNode);
 }
 
 bool Input::preflightElement(unsigned Index, void *&SaveInfo) {
   if (EC)
     return false;
   if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
+    HNode *Element = SQ->IsStreaming ? readSequenceElement(SQ)
+                                     : SQ->Entries[Index].get();
+    if (!Element)
+      return false;
     SaveInfo = CurrentNode;
-    CurrentNode = SQ->Entries[Index].get();
+    CurrentNode = Element;
     return true;
   }
   return false;
@@ -208,27 +252,22 @@ bool Input::preflightElement(unsigned Index, void *&SaveInfo) {
 
 void Input::postflightElement(void *SaveInfo) {
   CurrentNode = reinterpret_cast<HNode *>(SaveInfo);
+  SequenceHNode *SQ = cast<SequenceHNode>(CurrentNode);
+  if (SQ->IsStreaming)
+    finishSequenceElement(SQ);
 }
 
 unsigned Input::beginFlowSequence() { return beginSequence(); }
 
 bool Input::preflightFlowElement(unsigned index, void *&SaveInfo) {
-  if (EC)
-    return false;
-  if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
-    SaveInfo = CurrentNode;
-    CurrentNode = SQ->Entries[index].get();
-    return true;
-  }
-  return false;
+  return preflightElement(index, SaveInfo);
 }
 
 void Input::postflightFlowElement(void *SaveInfo) {
-  CurrentNode = reinterpret_cast<HNode *>(SaveInfo);
+  postflightElement(SaveInfo);
 }
 
-void Input::endFlowSequence() {
-}
+void Input::endFlowSequence() { endSequence(); }
 
 void Input::beginEnumScalar() {
   ScalarMatchFound = false;
@@ -262,6 +301,9 @@ void Input::endEnumScalar() {
 bool Input::beginBitSetScalar(bool &DoClear) {
   BitValuesUsed.clear();
   if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
+    // Bit values are looked up repeatedly, so read them all first.
+    if (SQ->IsStreaming)
+      readAllElements(SQ);
     BitValuesUsed.insert(BitValuesUsed.begin(), SQ->Entries.size(), false);
   } else {
     setError(CurrentNode, "expected sequence of bit values");
@@ -355,21 +397,9 @@ std::unique_ptr<Input::HNode> Input::createHNodes(Node *N) {
   } else if (MappingNode *Map = dyn_cast<MappingNode>(N)) {
     auto mapHNode = llvm::make_unique<MapHNode>(N);
     for (KeyValueNode &KVN : *Map) {
-      Node *KeyNode = KVN.getKey();
-      ScalarNode *KeyScalar = dyn_cast<ScalarNode>(KeyNode);
-      if (!KeyScalar) {
-        setError(KeyNode, "Map key must be a scalar");
+      StringRef KeyStr;
+      if (!readKey(KVN, KeyStr))
         break;
-      }
-      StringStorage.clear();
-      StringRef KeyStr = KeyScalar->getValue(StringStorage);
-      if (!StringStorage.empty()) {
-        // Copy string to permanent storage
-        unsigned Len = StringStorage.size();
-        char *Buf = StringAllocator.Allocate<char>(Len);
-        memcpy(Buf, &StringStorage[0], Len);
-        KeyStr = StringRef(Buf, Len);
-      }
       auto ValueHNode = this->createHNodes(KVN.getValue());
       if (EC)
         break;
@@ -384,6 +414,145 @@ std::unique_ptr<Input::HNode> Input::createHNodes(Node *N) {
   }
 }
 
+std::unique_ptr<Input::HNode> Input::createStreamingHNode(Node *N) {
+  if (isa<MappingNode>(N)) {
+    auto MN = llvm::make_unique<MapHNode>(N);
+    MN->IsStreaming = true;
+    return std::move(MN);
+  }
+  if (isa<SequenceNode>(N)) {
+    auto SQ = llvm::make_unique<SequenceHNode>(N);
+    SQ->IsStreaming = true;
+    return std::move(SQ);
+  }
+  return createHNodes(N);
+}
+
+bool Input::readKey(KeyValueNode &KVN, StringRef &Key) {
+  Node *KeyNode = KVN.getKey();
+  ScalarNode *KeyScalar = dyn_cast<ScalarNode>(KeyNode);
+  if (!KeyScalar) {
+    setError(KeyNode, "Map key must be a scalar");
+    return false;
+  }
+  SmallString<128> StringStorage;
+  Key = KeyScalar->getValue(StringStorage);
+  if (!StringStorage.empty()) {
+    // Copy string to permanent storage
+    unsigned Len = StringStorage.size();
+    char *Buf = StringAllocator.Allocate<char>(Len);
+    memcpy(Buf, &StringStorage[0], Len);
+    Key = StringRef(Buf, Len);
+  }
+  return true;
+}
+
+/// Return the value of Key in a streaming mapping, reading entries from the
+/// document until it is found. The entries read on the way are built in
+/// full, since the parser can't come back to them.
+Input::HNode *Input::readMapEntry(MapHNode *MN, StringRef Key) {
+  finishMapEntry(MN);
+  auto I = MN->Mapping.find(Key);
+  if (I != MN->Mapping.end())
+    return I->second.get();
+
+  if (!MN->Started) {
+    MN->Started = true;
+    MN->Next = cast<MappingNode>(MN->_node)->begin();
+  }
+  for (; MN->Next != MappingNode::iterator(); ++MN->Next) {
+    StringRef KeyStr;
+    if (!readKey(*MN->Next, KeyStr))
+      return nullptr;
+    Node *ValueNode = MN->Next->getValue();
+    if (KeyStr == Key) {
+      auto Value = createStreamingHNode(ValueNode);
+      if (EC)
+        return nullptr;
+      // Next is moved past this entry once it has been mapped.
+      MN->Pending = Value.get();
+      MN->Mapping[KeyStr] = std::move(Value);
+      return MN->Pending;
+    }
+    auto Value = createHNodes(ValueNode);
+    if (EC)
+      return nullptr;
+    MN->Mapping[KeyStr] = std::move(Value);
+  }
+  if (Strm->failed())
+    EC = make_error_code(errc::invalid_argument);
+  return nullptr;
+}
+
+void Input::finishMapEntry(MapHNode *MN) {
+  if (!MN->Pending)
+    return;
+  if (!EC) {
+    skipUnread(MN->Pending);
+    ++MN->Next;
+  }
+  MN->Pending = nullptr;
+}
+
+Input::HNode *Input::readSequenceElement(SequenceHNode *SQ) {
+  if (!SQ->Started) {
+    SQ->Started = true;
+    SQ->Next = cast<SequenceNode>(SQ->_node)->begin();
+  }
+  if (!(SQ->Next != SequenceNode::iterator())) {
+    if (Strm->failed())
+      EC = make_error_code(errc::invalid_argument);
+    return nullptr;
+  }
+  auto Element = createStreamingHNode(&*SQ->Next);
+  if (EC)
+    return nullptr;
+  SQ->Entries.push_back(std::move(Element));
+  return SQ->Entries.back().get();
+}
+
+void Input::finishSequenceElement(SequenceHNode *SQ) {
+  if (!EC) {
+    skipUnread(SQ->Entries.back().get());
+    ++SQ->Next;
+  }
+  SQ->Entries.clear();
+}
+
+/// Turn a streaming sequence that has not been read yet into a regular one.
+void Input::readAllElements(SequenceHNode *SQ) {
+  if (SQ->Started) {
+    setError(SQ, "sequence can only be read once in streaming mode");
+    return;
+  }
+  SQ->IsStreaming = false;
+  for (Node &SN : *cast<SequenceNode>(SQ->_node)) {
+    auto Entry = this->createHNodes(&SN);
+    if (EC)
+      break;
+    SQ->Entries.push_back(std::move(Entry));
+  }
+}
+
+/// Move the parser past what is left of a streaming node, so that its parent
+/// can move on to the next entry.
+void Input::skipUnread(HNode *hnode) {
+  if (MapHNode *MN = dyn_cast<MapHNode>(hnode)) {
+    if (!MN->IsStreaming || !MN->Started)
+      return;
+    finishMapEntry(MN);
+    while (MN->Next != MappingNode::iterator())
+      ++MN->Next;
+  } else if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(hnode)) {
+    if (!SQ->IsStreaming || !SQ->Started)
+      return;
+    if (!SQ->Entries.empty())
+      finishSequenceElement(SQ);
+    while (SQ->Next != SequenceNode::iterator())
+      ++SQ->Next;
+  }
+}
+
 bool Input::MapHNode::isValidKey(StringRef Key) {
   for (const char *K : ValidKeys) {
     if (Key.equals(K))
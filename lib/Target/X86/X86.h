@@ -64,6 +64,10 @@ FunctionPass *createX86PadShortFunctions();
 /// to eliminate execution delays in some Atom processors.
 FunctionPass *createX86FixupLEAs();
 
+/// createX86MergeConstantStores - Return a pass that merges adjacent stores
+/// of immediates into a single wider store after register allocation.
+FunctionPass *createX86MergeConstantStores();
+
 /// createX86CallFrameOptimization - Return a pass that optimizes
 /// the code-size of x86 call sequences. This is done by replacing
 /// esp-relative movs with pushes.
@@ -2414,6 +2414,21 @@ bool X86FastISel::fastLowerIntrinsicCall(const IntrinsicInst *II) {
 
     return lowerCallTo(II, "memset", II->getNumArgOperands() - 2);
   }
+  case Intrinsic::memmove: {
+    const MemMoveInst *MMI = cast<MemMoveInst>(II);
+
+    if (MMI->isVolatile())
+      return false;
+
+    unsigned SizeWidth = Subtarget->is64Bit() ? 64 : 32;
+    if (!MMI->getLength()->getType()->isIntegerTy(SizeWidth))
+      return false;
+
+    if (MMI->getSourceAddressSpace() > 255 || MMI->getDestAddressSpace() > 255)
+      return false;
+
+    return lowerCallTo(II, "memmove", II->getNumArgOperands() - 2);
+  }
   case Intrinsic::stackprotector: {
     // Emit code to store the stack guard onto the stack.
     EVT PtrTy = TLI.getPointerTy();
@@ -1159,6 +1159,13 @@ X86TargetLowering::X86TargetLowering(const X86TargetMachine &TM,
       setLoadExtAction(ISD::ZEXTLOAD, MVT::v8i32,  MVT::v8i16, Legal);
       setLoadExtAction(ISD::ZEXTLOAD, MVT::v4i64,  MVT::v4i16, Legal);
       setLoadExtAction(ISD::ZEXTLOAD, MVT::v4i64,  MVT::v4i32, Legal);
+
+      // AVX2 gathers 32- and 64-bit elements through VPGATHER/VGATHER.
+      static const MVT GatherVTs[] = { MVT::v4i32, MVT::v8i32, MVT::v2i64,
+                                       MVT::v4i64, MVT::v4f32, MVT::v8f32,
+                                       MVT::v2f64, MVT::v4f64 };
+      for (MVT VT : GatherVTs)
+        setOperationAction(ISD::MGATHER, VT, Custom);
     } else {
       setOperationAction(ISD::ADD,             MVT::v4i64, Custom);
       setOperationAction(ISD::ADD,             MVT::v8i32, Custom);
@@ -1628,6 +1635,9 @@ X86TargetLowering::X86TargetLowering(const X86TargetMachine &TM,
   MaxStoresPerMemmove = 8; // For @llvm.memmove -> sequence of stores
   MaxStoresPerMemmoveOptSize = Subtarget->isTargetDarwin() ? 8 : 4;
   setPrefLoopAlignment(4); // 2^4 bytes.
+  // Fetch and the decoded uop cache work on 32 byte windows on big cores.
+  if (!Subtarget->isAtom())
+    setFetchAlignment(5); // 2^5 bytes.
 
   // Predictable cmov don't hurt on atom because it's in-order.
   PredictableSelectIsExpensive = !Subtarget->isAtom();
@@ -17992,12 +18002,80 @@ static SDValue LowerMSCATTER(SDValue Op, const X86Subtarget *Subtarget,
   return Op;
 }
 
+/// Lower a masked gather on an AVX2 target to one of the
+/// x86_avx2_gather_* intrinsics. The type legalizer has already promoted the
+/// i1 mask to a vector of all-ones/all-zeros lanes, and split any gather whose
+/// index vector is wider than 256 bits.
+static SDValue LowerAVX2MGATHER(MaskedGatherSDNode *N,
+                                const X86Subtarget *Subtarget,
+                                SelectionDAG &DAG) {
+  MVT VT = N->getSimpleValueType(0);
+  SDValue Index = N->getIndex();
+  MVT IndexVT = Index.getSimpleValueType();
+  assert(VT.getVectorNumElements() == IndexVT.getVectorNumElements() &&
+         "Gather data and index vectors must have the same length");
+  SDLoc dl(N);
+
+  bool Is256 = VT.is256BitVector() || IndexVT.is256BitVector();
+  bool QIndex = IndexVT.getScalarSizeInBits() == 64;
+  unsigned IntNo;
+  switch (VT.getVectorElementType().SimpleTy) {
+  default: llvm_unreachable("Unsupported AVX2 gather type");
+  case MVT::i32:
+    IntNo = QIndex ? (Is256 ? Intrinsic::x86_avx2_gather_q_d_256
+                            : Intrinsic::x86_avx2_gather_q_d)
+                   : (Is256 ? Intrinsic::x86_avx2_gather_d_d_256
+                            : Intrinsic::x86_avx2_gather_d_d);
+    break;
+  case MVT::i64:
+    IntNo = QIndex ? (Is256 ? Intrinsic::x86_avx2_gather_q_q_256
+                            : Intrinsic::x86_avx2_gather_q_q)
+                   : (Is256 ? Intrinsic::x86_avx2_gather_d_q_256
+                            : Intrinsic::x86_avx2_gather_d_q);
+    break;
+  case MVT::f32:
+    IntNo = QIndex ? (Is256 ? Intrinsic::x86_avx2_gather_q_ps_256
+                            : Intrinsic::x86_avx2_gather_q_ps)
+                   : (Is256 ? Intrinsic::x86_avx2_gather_d_ps_256
+                            : Intrinsic::x86_avx2_gather_d_ps);
+    break;
+  case MVT::f64:
+    IntNo = QIndex ? (Is256 ? Intrinsic::x86_avx2_gather_q_pd_256
+                            : Intrinsic::x86_avx2_gather_q_pd)
+                   : (Is256 ? Intrinsic::x86_avx2_gather_d_pd_256
+                            : Intrinsic::x86_avx2_gather_d_pd);
+    break;
+  }
+
+  // The instruction only looks at the sign bit of each mask lane.
+  MVT MaskVT = MVT::getVectorVT(
+      MVT::getIntegerVT(VT.getScalarSizeInBits()), VT.getVectorNumElements());
+  SDValue Mask = DAG.getSExtOrTrunc(N->getMask(), dl, MaskVT);
+  Mask = DAG.getBitcast(VT, Mask);
+
+  // A zero base means that the index vector holds complete addresses.
+  SDValue Base = N->getBasePtr();
+  MVT PtrVT = Base.getSimpleValueType();
+  unsigned Scale = VT.getScalarSizeInBits() / 8;
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(Base);
+  if (C && C->isNullValue()) {
+    Base = DAG.getRegister(0, PtrVT);
+    Scale = 1;
+  }
+
+  SDValue Ops[] = { N->getChain(), DAG.getConstant(IntNo, dl, MVT::i32),
+                    N->getValue(), Base, Index, Mask,
+                    DAG.getConstant(Scale, dl, MVT::i8) };
+  SDValue Gather = DAG.getNode(ISD::INTRINSIC_W_CHAIN, dl,
+                               DAG.getVTList(VT, MVT::Other), Ops);
+  return DAG.getMergeValues({Gather, Gather.getValue(1)}, dl);
+}
+
 static SDValue LowerMGATHER(SDValue Op, const X86Subtarget *Subtarget,
                             SelectionDAG &DAG) {
-  assert(Subtarget->hasAVX512() &&
-         "MGATHER/MSCATTER are supported on AVX-512 arch only");
-
   MaskedGatherSDNode *N = cast<MaskedGatherSDNode>(Op.getNode());
+  if (!Subtarget->hasAVX512())
+    return LowerAVX2MGATHER(N, Subtarget, DAG);
   EVT VT = Op.getValueType();
   assert(VT.getScalarSizeInBits() >= 32 && "Unsupported gather op");
   SDLoc dl(Op);
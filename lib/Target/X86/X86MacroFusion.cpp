@@ -0,0 +1,98 @@
+//===- X86MacroFusion.cpp - X86 Macro Fusion ------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the X86 implementation of the DAG scheduling mutation to
+// pair instructions back to back.
+//
+// Recent Intel and AMD cores decode a CMP, TEST, AND, ADD, SUB, INC or DEC
+// immediately followed by a conditional branch into a single micro-op. The
+// generic MacroFusion mutation only adds a weak cluster edge towards the
+// branch, which register pressure and latency heuristics override freely.
+// This mutation additionally orders every other bottom node of the region
+// before the flag-setting instruction, so nothing can be scheduled between
+// the pair unless it depends on the compare.
+//
+//===----------------------------------------------------------------------===//
+
+#include "X86MacroFusion.h"
+#include "X86InstrInfo.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "x86-macro-fusion"
+
+STATISTIC(NumFused, "Number of flag-setting instructions pinned to a branch");
+
+static cl::opt<bool> EnableX86MacroFusion("x86-misched-fusion", cl::Hidden,
+  cl::desc("Keep macro-fusible instructions next to their branch."),
+  cl::init(true));
+
+namespace {
+class X86MacroFusion : public ScheduleDAGMutation {
+public:
+  void apply(ScheduleDAGMI *DAG) override;
+};
+} // end anonymous namespace
+
+/// Return true if nothing in the region is scheduled below \p SU, i.e. it is
+/// a root of bottom-up scheduling.
+static bool isBottomRoot(const SUnit &SU, const SUnit &ExitSU) {
+  for (const SDep &Succ : SU.Succs)
+    if (Succ.getSUnit() != &ExitSU)
+      return false;
+  return true;
+}
+
+void X86MacroFusion::apply(ScheduleDAGMI *DAG) {
+  if (!EnableX86MacroFusion)
+    return;
+
+  SUnit &ExitSU = DAG->ExitSU;
+  MachineInstr *Branch = ExitSU.getInstr();
+  if (!Branch || !Branch->isConditionalBranch())
+    return;
+
+  // Find the instruction in the region that defines the flags the branch
+  // reads.
+  SUnit *FlagsSU = nullptr;
+  for (const SDep &Dep : ExitSU.Preds) {
+    if (Dep.getKind() == SDep::Data && Dep.getReg() == X86::EFLAGS) {
+      FlagsSU = Dep.getSUnit();
+      break;
+    }
+  }
+  if (!FlagsSU || FlagsSU->isBoundaryNode() ||
+      !DAG->TII->shouldScheduleAdjacent(FlagsSU->getInstr(), Branch))
+    return;
+
+  // Let the bottom-up scheduler pick the flag-setting instruction first.
+  DAG->addEdge(&ExitSU, SDep(FlagsSU, SDep::Cluster));
+
+  // Every other root must be scheduled above it. An edge that would create a
+  // cycle is refused by addEdge; such a node depends on the flags anyway and
+  // could not have been fused.
+  for (SUnit &SU : DAG->SUnits) {
+    if (&SU == FlagsSU || !isBottomRoot(SU, ExitSU))
+      continue;
+    DAG->addEdge(FlagsSU, SDep(&SU, SDep::Artificial));
+  }
+
+  ++NumFused;
+  DEBUG(dbgs() << "Macro fuse SU(" << FlagsSU->NodeNum << ") with "
+               << *Branch);
+}
+
+std::unique_ptr<ScheduleDAGMutation> llvm::createX86MacroFusionDAGMutation() {
+  return make_unique<X86MacroFusion>();
+}
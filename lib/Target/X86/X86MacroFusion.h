@@ -0,0 +1,29 @@
+//===- X86MacroFusion.h - X86 Macro Fusion --------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the X86 definition of the DAG scheduling mutation to
+// pair instructions back to back.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_X86_X86MACROFUSION_H
+#define LLVM_LIB_TARGET_X86_X86MACROFUSION_H
+
+#include "llvm/CodeGen/MachineScheduler.h"
+
+namespace llvm {
+
+/// Return a DAG mutation that keeps the instruction setting the flags for the
+/// branch at the end of a scheduling region right before that branch, so
+/// that the pair can be macro-fused by the decoder.
+std::unique_ptr<ScheduleDAGMutation> createX86MacroFusionDAGMutation();
+
+} // end namespace llvm
+
+#endif
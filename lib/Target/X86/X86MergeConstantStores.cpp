@@ -0,0 +1,216 @@
+//===-- X86MergeConstantStores.cpp - Merge narrow constant stores ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a post-RA pass that merges back-to-back stores of
+// immediates to adjacent memory into a single wider store, e.g.
+//
+//   movb $1, (%rdi)
+//   movb $2, 1(%rdi)     =>    movw $513, (%rdi)
+//
+// DAGCombiner already merges consecutive stores within a selection DAG, but
+// it cannot see stores that only become neighbours after instruction
+// selection: stores from different IR blocks that branch folding has merged,
+// or stores reordered by the machine scheduler. Merged pairs are merged again
+// on the next sweep, so four byte stores become one 32-bit store. Stores are
+// only merged when the memory operand shows the wider access is naturally
+// aligned.
+//
+//===----------------------------------------------------------------------===//
+
+#include "X86.h"
+#include "X86InstrInfo.h"
+#include "X86Subtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "x86-merge-constant-stores"
+
+STATISTIC(NumStoresMerged, "Number of constant store pairs merged");
+
+static cl::opt<bool>
+EnableMergeConstantStores("x86-merge-constant-stores", cl::Hidden,
+                          cl::desc("Merge adjacent narrow constant stores "
+                                   "after register allocation"),
+                          cl::init(true));
+
+namespace {
+class X86MergeConstantStores : public MachineFunctionPass {
+public:
+  static char ID;
+  X86MergeConstantStores() : MachineFunctionPass(ID), TII(nullptr),
+                             Is64Bit(false) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  const char *getPassName() const override {
+    return "X86 Merge Constant Stores";
+  }
+
+private:
+  bool mergeInBlock(MachineBasicBlock &MBB);
+  MachineInstr *tryMerge(MachineInstr *First, MachineInstr *Second);
+
+  const X86InstrInfo *TII;
+  bool Is64Bit;
+};
+
+char X86MergeConstantStores::ID = 0;
+} // end anonymous namespace
+
+FunctionPass *llvm::createX86MergeConstantStores() {
+  return new X86MergeConstantStores();
+}
+
+/// Return the width in bytes of the constant store \p MI, or 0 if it is not
+/// one.
+static unsigned getConstantStoreSize(const MachineInstr *MI) {
+  switch (MI->getOpcode()) {
+  default:          return 0;
+  case X86::MOV8mi:  return 1;
+  case X86::MOV16mi: return 2;
+  case X86::MOV32mi: return 4;
+  }
+}
+
+/// Return the opcode of a constant store of \p Size bytes.
+static unsigned getConstantStoreOpcode(unsigned Size) {
+  switch (Size) {
+  default: llvm_unreachable("Unexpected store size");
+  case 2: return X86::MOV16mi;
+  case 4: return X86::MOV32mi;
+  case 8: return X86::MOV64mi32;
+  }
+}
+
+/// Return true if \p MI is a plain store we know everything about: a single
+/// non-volatile memory operand and an immediate displacement.
+static bool isMergeableStore(const MachineInstr *MI) {
+  if (!getConstantStoreSize(MI) || !MI->hasOneMemOperand())
+    return false;
+  const MachineMemOperand *MMO = *MI->memoperands_begin();
+  if (MMO->isVolatile())
+    return false;
+  return MI->getOperand(X86::AddrDisp).isImm() &&
+         MI->getOperand(X86::AddrNumOperands).isImm();
+}
+
+/// Return true if \p A and \p B address memory through the same base, index,
+/// scale and segment.
+static bool haveSameAddressBase(const MachineInstr *A, const MachineInstr *B) {
+  for (unsigned Op : {(unsigned)X86::AddrBaseReg, (unsigned)X86::AddrScaleAmt,
+                      (unsigned)X86::AddrIndexReg,
+                      (unsigned)X86::AddrSegmentReg})
+    if (!A->getOperand(Op).isIdenticalTo(B->getOperand(Op)))
+      return false;
+  return true;
+}
+
+MachineInstr *X86MergeConstantStores::tryMerge(MachineInstr *First,
+                                               MachineInstr *Second) {
+  if (!isMergeableStore(First) || !isMergeableStore(Second))
+    return nullptr;
+  unsigned Size = getConstantStoreSize(First);
+  if (getConstantStoreSize(Second) != Size || !haveSameAddressBase(First, Second))
+    return nullptr;
+  if (Size == 4 && !Is64Bit)
+    return nullptr;
+
+  // The two stores may come in either order; they do not overlap.
+  MachineInstr *Lo = First, *Hi = Second;
+  int64_t LoDisp = Lo->getOperand(X86::AddrDisp).getImm();
+  int64_t HiDisp = Hi->getOperand(X86::AddrDisp).getImm();
+  if (HiDisp < LoDisp) {
+    std::swap(Lo, Hi);
+    std::swap(LoDisp, HiDisp);
+  }
+  if (HiDisp - LoDisp != Size || !isInt<32>(LoDisp))
+    return nullptr;
+  // Only merge when the wide store keeps its natural alignment. A misaligned
+  // store can be split across cache lines and is no cheaper than the pair.
+  if ((*Lo->memoperands_begin())->getAlignment() < 2 * Size)
+    return nullptr;
+
+  unsigned Bits = Size * 8;
+  uint64_t LoImm = Lo->getOperand(X86::AddrNumOperands).getImm();
+  uint64_t HiImm = Hi->getOperand(X86::AddrNumOperands).getImm();
+  uint64_t Mask = (UINT64_C(1) << Bits) - 1;
+  uint64_t Combined = (LoImm & Mask) | ((HiImm & Mask) << Bits);
+  int64_t Imm = SignExtend64(Combined, 2 * Bits);
+  // MOV64mi32 sign-extends a 32-bit immediate.
+  if (Size == 4 && !isInt<32>(Imm))
+    return nullptr;
+
+  MachineFunction &MF = *First->getParent()->getParent();
+  MachineMemOperand *MMO = MF.getMachineMemOperand(
+      *Lo->memoperands_begin(), 0, 2 * Size);
+
+  // Insert the wide store where the second store was, so every instruction
+  // that was ordered before either store still is.
+  MachineInstrBuilder MIB =
+      BuildMI(*Second->getParent(), Second, Second->getDebugLoc(),
+              TII->get(getConstantStoreOpcode(2 * Size)));
+  for (unsigned i = 0; i != X86::AddrNumOperands; ++i)
+    MIB.addOperand(Lo->getOperand(i));
+  MIB.addImm(Imm);
+  MIB.addMemOperand(MMO);
+
+  DEBUG(dbgs() << "Merging:\n  " << *First << "  " << *Second << "into:\n  "
+               << *MIB);
+  First->eraseFromParent();
+  Second->eraseFromParent();
+  ++NumStoresMerged;
+  return MIB;
+}
+
+bool X86MergeConstantStores::mergeInBlock(MachineBasicBlock &MBB) {
+  bool Changed = false;
+  MachineBasicBlock::iterator I = MBB.begin(), E = MBB.end();
+  while (I != E) {
+    MachineInstr *First = I;
+    MachineBasicBlock::iterator Next = std::next(I);
+    while (Next != E && Next->isDebugValue())
+      ++Next;
+    if (Next == E)
+      break;
+    if (MachineInstr *Merged = tryMerge(First, Next)) {
+      Changed = true;
+      I = Merged;
+      continue;
+    }
+    I = Next;
+  }
+  return Changed;
+}
+
+bool X86MergeConstantStores::runOnMachineFunction(MachineFunction &MF) {
+  if (!EnableMergeConstantStores)
+    return false;
+
+  const X86Subtarget &STI = MF.getSubtarget<X86Subtarget>();
+  TII = STI.getInstrInfo();
+  Is64Bit = STI.is64Bit();
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : MF) {
+    // Each sweep can double the width of the stores merged by the previous
+    // one.
+    while (mergeInBlock(MBB))
+      Changed = true;
+  }
+  return Changed;
+}
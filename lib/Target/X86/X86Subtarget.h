@@ -480,6 +480,11 @@ public:
 
   bool enableEarlyIfConversion() const override;
 
+  /// Branches the program marks unpredictable are better off as cmovs.
+  bool enableEarlyIfConversionOfUnpredictable() const override {
+    return hasCMov();
+  }
+
   /// Return the instruction itineraries based on the subtarget selection.
   const InstrItineraryData *getInstrItineraryData() const override {
     return &InstrItins;
@@ -18,6 +18,7 @@
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/CodeGen/BasicTTIImpl.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Target/CostTable.h"
 #include "llvm/Target/TargetLowering.h"
@@ -25,6 +26,24 @@ using namespace llvm;
 
 #define DEBUG_TYPE "x86tti"
 
+// Running 512-bit code lowers the turbo frequency of the whole core on current
+// AVX-512 parts. Code that is only partly vectorized can lose more to the
+// lower clock than it gains from the wider vectors, so let users cap the width
+// the vectorizers target. A "prefer-vector-width" function attribute
+// overrides this for individual functions.
+static cl::opt<unsigned> PreferVectorWidth(
+    "x86-prefer-vector-width", cl::Hidden, cl::init(0),
+    cl::desc("Widest vector, in bits, the vectorizers should target "
+             "(0 = widest legal width)"));
+
+unsigned X86TTIImpl::getPreferredVectorWidth(const Function &F) {
+  unsigned Width = PreferVectorWidth;
+  Attribute Attr = F.getFnAttribute("prefer-vector-width");
+  if (Attr.isStringAttribute())
+    Attr.getValueAsString().getAsInteger(0, Width);
+  return Width;
+}
+
 //===----------------------------------------------------------------------===//
 //
 // X86 cost model.
@@ -54,8 +73,10 @@ unsigned X86TTIImpl::getNumberOfRegisters(bool Vector) {
 
 unsigned X86TTIImpl::getRegisterBitWidth(bool Vector) {
   if (Vector) {
-    if (ST->hasAVX512()) return 512;
-    if (ST->hasAVX()) return 256;
+    if (ST->hasAVX512() && (!PreferredWidth || PreferredWidth >= 512))
+      return 512;
+    if (ST->hasAVX() && (!PreferredWidth || PreferredWidth >= 256))
+      return 256;
     if (ST->hasSSE1()) return 128;
     return 0;
   }
@@ -130,6 +151,19 @@ unsigned X86TTIImpl::getArithmeticInstrCost(
       return LT.first * AVX2UniformConstCostTable[Idx].Cost;
   }
 
+  static const CostTblEntry<MVT::SimpleValueType> AVX512BWCostTable[] = {
+    // Per-element shifts and multiplies of words only exist with AVX512BW.
+    { ISD::SHL,     MVT::v32i16,   1 }, // vpsllvw
+    { ISD::SRL,     MVT::v32i16,   1 }, // vpsrlvw
+    { ISD::SRA,     MVT::v32i16,   1 }, // vpsravw
+    { ISD::MUL,     MVT::v32i16,   1 }, // vpmullw
+    { ISD::MUL,     MVT::v64i8,   11 }, // extend/vpmullw/trunc sequence.
+  };
+
+  static const CostTblEntry<MVT::SimpleValueType> AVX512DQCostTable[] = {
+    { ISD::MUL,     MVT::v8i64,    1 }, // vpmullq
+  };
+
   static const CostTblEntry<MVT::SimpleValueType> AVX512CostTable[] = {
     { ISD::SHL,     MVT::v16i32,    1 },
     { ISD::SRL,     MVT::v16i32,    1 },
@@ -137,6 +171,15 @@ unsigned X86TTIImpl::getArithmeticInstrCost(
     { ISD::SHL,     MVT::v8i64,    1 },
     { ISD::SRL,     MVT::v8i64,    1 },
     { ISD::SRA,     MVT::v8i64,    1 },
+
+    // Without AVX512DQ a 64-bit multiply is 3 x vpmuludq, 3 x shift, 2 x add.
+    { ISD::MUL,     MVT::v8i64,    8 },
+
+    // Vectorizing division is a bad idea. See the SSE2 table for more comments.
+    { ISD::SDIV,  MVT::v16i32, 16*20 },
+    { ISD::SDIV,  MVT::v8i64,   8*20 },
+    { ISD::UDIV,  MVT::v16i32, 16*20 },
+    { ISD::UDIV,  MVT::v8i64,   8*20 },
   };
 
   static const CostTblEntry<MVT::SimpleValueType> AVX2CostTable[] = {
@@ -174,6 +217,18 @@ unsigned X86TTIImpl::getArithmeticInstrCost(
     { ISD::UDIV,  MVT::v4i64,  4*20 },
   };
 
+  if (ST->hasBWI()) {
+    int Idx = CostTableLookup(AVX512BWCostTable, ISD, LT.second);
+    if (Idx != -1)
+      return LT.first * AVX512BWCostTable[Idx].Cost;
+  }
+
+  if (ST->hasDQI()) {
+    int Idx = CostTableLookup(AVX512DQCostTable, ISD, LT.second);
+    if (Idx != -1)
+      return LT.first * AVX512DQCostTable[Idx].Cost;
+  }
+
   if (ST->hasAVX512()) {
     int Idx = CostTableLookup(AVX512CostTable, ISD, LT.second);
     if (Idx != -1)
@@ -357,6 +412,13 @@ unsigned X86TTIImpl::getShuffleCost(TTI::ShuffleKind Kind, Type *Tp, int Index,
     if (LT.second.getSizeInBits() > 128)
       Cost = 3; // Extract + insert + copy.
 
+    // AVX-512 can reverse a whole register with one variable permute. Word
+    // permutes (vpermw) need AVX512BW; there is no byte permute.
+    unsigned EltSize = LT.second.getScalarSizeInBits();
+    if (LT.second.getSizeInBits() == 512 &&
+        (EltSize >= 32 || (EltSize == 16 && ST->hasBWI())))
+      Cost = 1; // vpermps/vpermpd/vpermd/vpermq/vpermw
+
     // Multiple by the number of parts.
     return Cost * LT.first;
   }
@@ -371,6 +433,33 @@ unsigned X86TTIImpl::getShuffleCost(TTI::ShuffleKind Kind, Type *Tp, int Index,
     if (ST->hasAVX2() && LT.second == MVT::v16i16)
       return LT.first;
 
+    static const CostTblEntry<MVT::SimpleValueType> AVX512AltShuffleTbl[] = {
+      // Masked moves with an immediate mask.
+      {ISD::VECTOR_SHUFFLE, MVT::v8i64,  1},  // vpblendmq
+      {ISD::VECTOR_SHUFFLE, MVT::v8f64,  1},  // vblendmpd
+      {ISD::VECTOR_SHUFFLE, MVT::v16i32, 1},  // vpblendmd
+      {ISD::VECTOR_SHUFFLE, MVT::v16f32, 1},  // vblendmps
+    };
+
+    static const CostTblEntry<MVT::SimpleValueType> AVX512BWAltShuffleTbl[] = {
+      {ISD::VECTOR_SHUFFLE, MVT::v32i16, 1},  // vpblendmw
+      {ISD::VECTOR_SHUFFLE, MVT::v64i8,  1},  // vpblendmb
+    };
+
+    if (ST->hasBWI()) {
+      int Idx = CostTableLookup(AVX512BWAltShuffleTbl, ISD::VECTOR_SHUFFLE,
+                                LT.second);
+      if (Idx != -1)
+        return LT.first * AVX512BWAltShuffleTbl[Idx].Cost;
+    }
+
+    if (ST->hasAVX512()) {
+      int Idx = CostTableLookup(AVX512AltShuffleTbl, ISD::VECTOR_SHUFFLE,
+                                LT.second);
+      if (Idx != -1)
+        return LT.first * AVX512AltShuffleTbl[Idx].Cost;
+    }
+
     static const CostTblEntry<MVT::SimpleValueType> AVXAltShuffleTbl[] = {
       {ISD::VECTOR_SHUFFLE, MVT::v4i64, 1},  // vblendpd
       {ISD::VECTOR_SHUFFLE, MVT::v4f64, 1},  // vblendpd
@@ -529,13 +618,59 @@ unsigned X86TTIImpl::getCastInstrCost(unsigned Opcode, Type *Dst, Type *Src) {
     { ISD::SINT_TO_FP,  MVT::v8f64,  MVT::v8i1,   4 },
     { ISD::SINT_TO_FP,  MVT::v8f64,  MVT::v8i16,  2 },
     { ISD::SINT_TO_FP,  MVT::v8f64,  MVT::v8i32,  1 },
+
+    // Unsigned and truncating conversions are single instructions.
+    { ISD::UINT_TO_FP,  MVT::v16f32, MVT::v16i32, 1 }, // vcvtudq2ps
+    { ISD::UINT_TO_FP,  MVT::v8f64,  MVT::v8i32,  1 }, // vcvtudq2pd
+    { ISD::FP_TO_SINT,  MVT::v16i32, MVT::v16f32, 1 }, // vcvttps2dq
+    { ISD::FP_TO_UINT,  MVT::v16i32, MVT::v16f32, 1 }, // vcvttps2udq
+    { ISD::FP_TO_SINT,  MVT::v8i32,  MVT::v8f64,  1 }, // vcvttpd2dq
+    { ISD::FP_TO_UINT,  MVT::v8i32,  MVT::v8f64,  1 }, // vcvttpd2udq
+
+    { ISD::SIGN_EXTEND, MVT::v8i64,  MVT::v8i16,  1 },
+    { ISD::ZERO_EXTEND, MVT::v8i64,  MVT::v8i16,  1 },
+    { ISD::SIGN_EXTEND, MVT::v8i64,  MVT::v8i32,  1 },
+    { ISD::ZERO_EXTEND, MVT::v8i64,  MVT::v8i32,  1 },
+
+    // Mask registers: a compare or test produces the mask, a masked move of
+    // all-ones materializes it.
+    { ISD::TRUNCATE,    MVT::v16i1,  MVT::v16i32, 2 }, // vpslld + vptestmd
+    { ISD::TRUNCATE,    MVT::v8i1,   MVT::v8i64,  2 }, // vpsllq + vptestmq
+    { ISD::SIGN_EXTEND, MVT::v8i64,  MVT::v8i1,   2 },
+    { ISD::ZERO_EXTEND, MVT::v8i64,  MVT::v8i1,   2 },
+  };
+
+  static const TypeConversionCostTblEntry<MVT::SimpleValueType>
+  AVX512DQConversionTbl[] = {
+    // AVX512DQ adds direct conversions between 64-bit integers and FP.
+    { ISD::SINT_TO_FP,  MVT::v8f64,  MVT::v8i64,  1 }, // vcvtqq2pd
+    { ISD::UINT_TO_FP,  MVT::v8f64,  MVT::v8i64,  1 }, // vcvtuqq2pd
+    { ISD::SINT_TO_FP,  MVT::v8f32,  MVT::v8i64,  1 }, // vcvtqq2ps
+    { ISD::UINT_TO_FP,  MVT::v8f32,  MVT::v8i64,  1 }, // vcvtuqq2ps
+    { ISD::FP_TO_SINT,  MVT::v8i64,  MVT::v8f64,  1 }, // vcvttpd2qq
+    { ISD::FP_TO_UINT,  MVT::v8i64,  MVT::v8f64,  1 }, // vcvttpd2uqq
+    { ISD::FP_TO_SINT,  MVT::v8i64,  MVT::v8f32,  1 }, // vcvttps2qq
+    { ISD::FP_TO_UINT,  MVT::v8i64,  MVT::v8f32,  1 }, // vcvttps2uqq
   };
 
+  // The AVX-512 tables are looked up on the legalized types. A conversion
+  // whose source and destination are both split into the same number of legal
+  // vectors is done once per part. Entries whose types are split differently,
+  // like v16i32 <- v8i64, already account for the split.
+  unsigned NumParts = LTSrc.first == LTDest.first ? LTSrc.first : 1;
+
+  if (ST->hasDQI()) {
+    int Idx = ConvertCostTableLookup(AVX512DQConversionTbl, ISD,
+                                     LTDest.second, LTSrc.second);
+    if (Idx != -1)
+      return NumParts * AVX512DQConversionTbl[Idx].Cost;
+  }
+
   if (ST->hasAVX512()) {
     int Idx = ConvertCostTableLookup(AVX512ConversionTbl, ISD, LTDest.second,
                                      LTSrc.second);
     if (Idx != -1)
-      return AVX512ConversionTbl[Idx].Cost;
+      return NumParts * AVX512ConversionTbl[Idx].Cost;
   }
   EVT SrcTy = TLI->getValueType(Src);
   EVT DstTy = TLI->getValueType(Dst);
@@ -705,8 +840,28 @@ unsigned X86TTIImpl::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
     { ISD::SETCC,   MVT::v16i32,  1 },
     { ISD::SETCC,   MVT::v8f64,   1 },
     { ISD::SETCC,   MVT::v16f32,  1 },
+
+    // Selects are a single masked blend on the compare's mask register.
+    { ISD::SELECT,  MVT::v8i64,   1 },
+    { ISD::SELECT,  MVT::v16i32,  1 },
+    { ISD::SELECT,  MVT::v8f64,   1 },
+    { ISD::SELECT,  MVT::v16f32,  1 },
+  };
+
+  static const CostTblEntry<MVT::SimpleValueType> AVX512BWCostTbl[] = {
+    { ISD::SETCC,   MVT::v32i16,  1 },
+    { ISD::SETCC,   MVT::v64i8,   1 },
+
+    { ISD::SELECT,  MVT::v32i16,  1 },
+    { ISD::SELECT,  MVT::v64i8,   1 },
   };
 
+  if (ST->hasBWI()) {
+    int Idx = CostTableLookup(AVX512BWCostTbl, ISD, MTy);
+    if (Idx != -1)
+      return LT.first * AVX512BWCostTbl[Idx].Cost;
+  }
+
   if (ST->hasAVX512()) {
     int Idx = CostTableLookup(AVX512CostTbl, ISD, MTy);
     if (Idx != -1)
@@ -818,6 +973,33 @@ unsigned X86TTIImpl::getMemoryOpCost(unsigned Opcode, Type *Src,
   return Cost;
 }
 
+unsigned X86TTIImpl::getGatherScatterOpCost(unsigned Opcode, Type *DataTy,
+                                            Value *Ptr, bool VariableMask,
+                                            unsigned Alignment) {
+  assert(DataTy->isVectorTy() && "Gather/scatter of a scalar type");
+  if ((Opcode == Instruction::Load && !isLegalMaskedGather(DataTy)) ||
+      (Opcode == Instruction::Store && !isLegalMaskedScatter(DataTy)))
+    return BaseT::getGatherScatterOpCost(Opcode, DataTy, Ptr, VariableMask,
+                                         Alignment);
+
+  // A gather or scatter is microcoded as one memory access per lane plus a
+  // fixed setup overhead, on every implementation so far. Types wider than
+  // a register are split, and so are gathers whose 64-bit index vector does
+  // not fit in a register.
+  unsigned VF = DataTy->getVectorNumElements();
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(DataTy);
+  unsigned SplitFactor = LT.first;
+  if (Ptr && Ptr->getType()->isVectorTy()) {
+    std::pair<unsigned, MVT> IdxLT =
+        TLI->getTypeLegalizationCost(Ptr->getType());
+    SplitFactor = std::max(SplitFactor, IdxLT.first);
+  }
+  const unsigned GSOverhead = 2;
+  unsigned MemOpCost = getMemoryOpCost(Opcode, DataTy->getScalarType(),
+                                       Alignment, 0);
+  return SplitFactor * GSOverhead + VF * MemOpCost;
+}
+
 unsigned X86TTIImpl::getMaskedMemoryOpCost(unsigned Opcode, Type *SrcTy,
                                            unsigned Alignment,
                                            unsigned AddressSpace) {
@@ -1130,3 +1312,28 @@ bool X86TTIImpl::isLegalMaskedStore(Type *DataType, int Consecutive) {
   return isLegalMaskedLoad(DataType, Consecutive);
 }
 
+bool X86TTIImpl::isLegalMaskedGather(Type *DataTy) {
+  // AVX2 gathers and AVX-512 gathers/scatters work on 32- and 64-bit
+  // elements only. Vectors wider than a register are split by type
+  // legalization. A scalar type asks whether vectors of that element type
+  // can be gathered at all.
+  if (!ST->hasAVX2())
+    return false;
+  Type *ScalarTy = DataTy->getScalarType();
+  unsigned EltWidth = ScalarTy->getPrimitiveSizeInBits();
+  if (!(ScalarTy->isIntegerTy() || ScalarTy->isFloatingPointTy()) ||
+      (EltWidth != 32 && EltWidth != 64))
+    return false;
+  if (!DataTy->isVectorTy())
+    return true;
+
+  unsigned NumElts = DataTy->getVectorNumElements();
+  unsigned DataWidth = NumElts * EltWidth;
+  return isPowerOf2_32(NumElts) && DataWidth >= 128;
+}
+
+bool X86TTIImpl::isLegalMaskedScatter(Type *DataType) {
+  // AVX2 has no scatter instructions.
+  return ST->hasAVX512() && isLegalMaskedGather(DataType);
+}
+
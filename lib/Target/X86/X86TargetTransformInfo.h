@@ -33,31 +33,40 @@ class X86TTIImpl : public BasicTTIImplBase<X86TTIImpl> {
   const X86Subtarget *ST;
   const X86TargetLowering *TLI;
 
+  /// Widest vector the vectorizers should target, in bits, or 0 for the
+  /// widest legal width.
+  unsigned PreferredWidth;
+
   unsigned getScalarizationOverhead(Type *Ty, bool Insert, bool Extract);
+  static unsigned getPreferredVectorWidth(const Function &F);
 
   const X86Subtarget *getST() const { return ST; }
   const X86TargetLowering *getTLI() const { return TLI; }
 
 public:
   explicit X86TTIImpl(const X86TargetMachine *TM, Function &F)
-      : BaseT(TM), ST(TM->getSubtargetImpl(F)), TLI(ST->getTargetLowering()) {}
+      : BaseT(TM), ST(TM->getSubtargetImpl(F)), TLI(ST->getTargetLowering()),
+        PreferredWidth(getPreferredVectorWidth(F)) {}
 
   // Provide value semantics. MSVC requires that we spell all of these out.
   X86TTIImpl(const X86TTIImpl &Arg)
-      : BaseT(static_cast<const BaseT &>(Arg)), ST(Arg.ST), TLI(Arg.TLI) {}
+      : BaseT(static_cast<const BaseT &>(Arg)), ST(Arg.ST), TLI(Arg.TLI),
+        PreferredWidth(Arg.PreferredWidth) {}
   X86TTIImpl(X86TTIImpl &&Arg)
       : BaseT(std::move(static_cast<BaseT &>(Arg))), ST(std::move(Arg.ST)),
-        TLI(std::move(Arg.TLI)) {}
+        TLI(std::move(Arg.TLI)), PreferredWidth(Arg.PreferredWidth) {}
   X86TTIImpl &operator=(const X86TTIImpl &RHS) {
     BaseT::operator=(static_cast<const BaseT &>(RHS));
     ST = RHS.ST;
     TLI = RHS.TLI;
+    PreferredWidth = RHS.PreferredWidth;
     return *this;
   }
   X86TTIImpl &operator=(X86TTIImpl &&RHS) {
     BaseT::operator=(std::move(static_cast<BaseT &>(RHS)));
     ST = std::move(RHS.ST);
     TLI = std::move(RHS.TLI);
+    PreferredWidth = RHS.PreferredWidth;
     return *this;
   }
 
@@ -88,6 +97,8 @@ public:
                            unsigned AddressSpace);
   unsigned getMaskedMemoryOpCost(unsigned Opcode, Type *Src, unsigned Alignment,
                                  unsigned AddressSpace);
+  unsigned getGatherScatterOpCost(unsigned Opcode, Type *DataTy, Value *Ptr,
+                                  bool VariableMask, unsigned Alignment);
 
   unsigned getAddressComputationCost(Type *PtrTy, bool IsComplex);
 
@@ -103,6 +114,8 @@ public:
                          Type *Ty);
   bool isLegalMaskedLoad(Type *DataType, int Consecutive);
   bool isLegalMaskedStore(Type *DataType, int Consecutive);
+  bool isLegalMaskedGather(Type *DataType);
+  bool isLegalMaskedScatter(Type *DataType);
 
   /// @}
 };
@@ -38,6 +38,7 @@ void llvm::initializeIPO(PassRegistry &Registry) {
   initializeSingleLoopExtractorPass(Registry);
   initializeLowerBitSetsPass(Registry);
   initializeMergeFunctionsPass(Registry);
+  initializeMultiVersioningPass(Registry);
   initializePartialInlinerPass(Registry);
   initializePruneEHPass(Registry);
   initializeStripDeadPrototypesPassPass(Registry);
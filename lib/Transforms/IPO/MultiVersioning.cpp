@@ -0,0 +1,323 @@
+//===-- MultiVersioning.cpp - Clone functions per CPU feature set ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass clones functions carrying a "target-versions" attribute once per
+// listed feature set and turns the original function into a dispatcher that
+// picks the best clone for the running CPU.
+//
+// The attribute value is a ';'-separated list of versions in priority order,
+// each of which is a ','-separated list of subtarget features, e.g.
+//
+//   "target-versions"="avx2,fma;sse4.2"
+//
+// Every clone gets those features appended to its "target-features"
+// attribute, so the code generator compiles it for that subtarget. A default
+// clone keeps the original features. The first call through the dispatcher
+// runs a resolver, which queries the same CPU model runtime used by
+// __builtin_cpu_supports (__cpu_indicator_init and __cpu_model, provided by
+// libgcc and compiler-rt), and caches the chosen clone in a function pointer.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "multiversion"
+
+STATISTIC(NumMultiVersioned, "Number of functions multiversioned");
+STATISTIC(NumVersionClones, "Number of feature-specific clones created");
+
+static const char VersionsAttr[] = "target-versions";
+
+/// Return the bit for \p Feature in __cpu_model.__cpu_features[0], or -1 if
+/// the runtime cannot detect it. The numbering follows the processor_features
+/// enum shared by libgcc and compiler-rt.
+static int getCPUFeatureBit(StringRef Feature) {
+  return StringSwitch<int>(Feature)
+      .Case("cmov", 0)
+      .Case("mmx", 1)
+      .Case("popcnt", 2)
+      .Case("sse", 3)
+      .Case("sse2", 4)
+      .Case("sse3", 5)
+      .Case("ssse3", 6)
+      .Case("sse4.1", 7)
+      .Case("sse4.2", 8)
+      .Case("avx", 9)
+      .Case("avx2", 10)
+      .Case("sse4a", 11)
+      .Case("fma4", 12)
+      .Case("xop", 13)
+      .Case("fma", 14)
+      .Case("avx512f", 15)
+      .Case("bmi", 16)
+      .Case("bmi2", 17)
+      .Default(-1);
+}
+
+namespace {
+/// One requested version of a function: its features and the mask of
+/// __cpu_model feature bits that must all be set to select it.
+struct FunctionVersion {
+  SmallVector<StringRef, 4> Features;
+  uint32_t Mask;
+};
+
+class MultiVersioning : public ModulePass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  MultiVersioning() : ModulePass(ID) {
+    initializeMultiVersioningPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+
+private:
+  bool parseVersions(Function &F, SmallVectorImpl<FunctionVersion> &Versions);
+  Function *cloneVersion(Function &F, StringRef Suffix, StringRef Features);
+  Function *buildResolver(Function &F, ArrayRef<FunctionVersion> Versions,
+                          ArrayRef<Function *> Clones, Function *Default);
+  void buildDispatcher(Function &F, Function *Resolver);
+};
+} // end anonymous namespace
+
+char MultiVersioning::ID = 0;
+INITIALIZE_PASS(MultiVersioning, "multiversion",
+                "Clone functions per CPU feature set", false, false)
+
+ModulePass *llvm::createMultiVersioningPass() { return new MultiVersioning(); }
+
+static void removeVersionsAttr(Function &F) {
+  AttrBuilder B;
+  B.addAttribute(VersionsAttr);
+  F.setAttributes(F.getAttributes().removeAttributes(
+      F.getContext(), AttributeSet::FunctionIndex, B));
+}
+
+bool MultiVersioning::parseVersions(Function &F,
+                                    SmallVectorImpl<FunctionVersion> &Versions) {
+  StringRef Value = F.getFnAttribute(VersionsAttr).getValueAsString();
+  SmallVector<StringRef, 4> Specs;
+  Value.split(Specs, ";", -1, false);
+
+  for (StringRef Spec : Specs) {
+    FunctionVersion V;
+    V.Mask = 0;
+    Spec.split(V.Features, ",", -1, false);
+    for (StringRef &Feature : V.Features) {
+      Feature = Feature.trim();
+      int Bit = getCPUFeatureBit(Feature);
+      if (Bit < 0) {
+        F.getContext().emitError("function '" + F.getName() +
+                                 "' requests unsupported target version "
+                                 "feature '" + Feature + "'");
+        return false;
+      }
+      V.Mask |= 1u << Bit;
+    }
+    if (!V.Features.empty())
+      Versions.push_back(V);
+  }
+  return !Versions.empty();
+}
+
+Function *MultiVersioning::cloneVersion(Function &F, StringRef Suffix,
+                                        StringRef Features) {
+  Function *NewF = Function::Create(F.getFunctionType(),
+                                    GlobalValue::InternalLinkage,
+                                    F.getName() + "." + Suffix, F.getParent());
+  ValueToValueMapTy VMap;
+  Function::arg_iterator DestI = NewF->arg_begin();
+  for (Argument &Arg : F.args()) {
+    DestI->setName(Arg.getName());
+    VMap[&Arg] = DestI++;
+  }
+  SmallVector<ReturnInst *, 8> Returns;
+  CloneFunctionInto(NewF, &F, VMap, /*ModuleLevelChanges=*/false, Returns);
+  NewF->setLinkage(GlobalValue::InternalLinkage);
+  NewF->setVisibility(GlobalValue::DefaultVisibility);
+  NewF->setDLLStorageClass(GlobalValue::DefaultStorageClass);
+  removeVersionsAttr(*NewF);
+
+  if (!Features.empty()) {
+    std::string FS = F.getFnAttribute("target-features").getValueAsString();
+    if (!FS.empty())
+      FS += ",";
+    FS += Features;
+    NewF->addFnAttr("target-features", FS);
+  }
+  return NewF;
+}
+
+Function *MultiVersioning::buildResolver(Function &F,
+                                         ArrayRef<FunctionVersion> Versions,
+                                         ArrayRef<Function *> Clones,
+                                         Function *Default) {
+  Module &M = *F.getParent();
+  LLVMContext &Ctx = M.getContext();
+  Type *Int32Ty = Type::getInt32Ty(Ctx);
+  PointerType *FPtrTy = F.getType();
+
+  // struct __processor_model {
+  //   unsigned int __cpu_vendor;
+  //   unsigned int __cpu_type;
+  //   unsigned int __cpu_subtype;
+  //   unsigned int __cpu_features[1];
+  // };
+  StructType *CPUModelTy = StructType::get(Int32Ty, Int32Ty, Int32Ty,
+                                           ArrayType::get(Int32Ty, 1),
+                                           nullptr);
+  Constant *CPUModel = M.getOrInsertGlobal("__cpu_model", CPUModelTy);
+  Constant *CPUInit = M.getOrInsertFunction("__cpu_indicator_init",
+                                            Type::getVoidTy(Ctx), nullptr);
+
+  Function *Resolver =
+      Function::Create(FunctionType::get(FPtrTy, false),
+                       GlobalValue::InternalLinkage,
+                       F.getName() + ".resolver", &M);
+  Resolver->addFnAttr(Attribute::NoUnwind);
+
+  IRBuilder<> B(BasicBlock::Create(Ctx, "entry", Resolver));
+  B.CreateCall(CPUInit, {});
+  Value *Idxs[] = {B.getInt32(0), B.getInt32(3), B.getInt32(0)};
+  Value *Features = B.CreateLoad(B.CreateInBoundsGEP(CPUModelTy, CPUModel,
+                                                     Idxs),
+                                 "cpu.features");
+
+  // Versions are tried in the order they were listed.
+  for (unsigned I = 0, E = Versions.size(); I != E; ++I) {
+    Value *Mask = B.getInt32(Versions[I].Mask);
+    Value *Has = B.CreateICmpEQ(B.CreateAnd(Features, Mask), Mask);
+    BasicBlock *Ret = BasicBlock::Create(Ctx, "select", Resolver);
+    BasicBlock *Next = BasicBlock::Create(Ctx, "next", Resolver);
+    B.CreateCondBr(Has, Ret, Next);
+    ReturnInst::Create(Ctx, Clones[I], Ret);
+    B.SetInsertPoint(Next);
+  }
+  B.CreateRet(Default);
+  return Resolver;
+}
+
+void MultiVersioning::buildDispatcher(Function &F, Function *Resolver) {
+  Module &M = *F.getParent();
+  LLVMContext &Ctx = M.getContext();
+  PointerType *FPtrTy = F.getType();
+
+  GlobalVariable *Cache =
+      new GlobalVariable(M, FPtrTy, false, GlobalValue::InternalLinkage,
+                         ConstantPointerNull::get(FPtrTy),
+                         F.getName() + ".resolved");
+  unsigned Align = M.getDataLayout().getPointerABIAlignment();
+  Cache->setAlignment(Align);
+
+  // deleteBody makes the function external; the dispatcher keeps the
+  // original linkage so internal and linkonce_odr symbols stay that way.
+  GlobalValue::LinkageTypes Linkage = F.getLinkage();
+  F.deleteBody();
+  F.setLinkage(Linkage);
+  removeVersionsAttr(F);
+
+  BasicBlock *Entry = BasicBlock::Create(Ctx, "entry", &F);
+  BasicBlock *Resolve = BasicBlock::Create(Ctx, "resolve", &F);
+  BasicBlock *Call = BasicBlock::Create(Ctx, "call", &F);
+
+  IRBuilder<> B(Entry);
+  // The cache may be read and written by several threads at once. Racing
+  // threads all compute the same answer and nothing else is published through
+  // it, so unordered accesses, which only rule out torn values, are enough.
+  LoadInst *Cached = B.CreateAlignedLoad(Cache, Align, "cached");
+  Cached->setAtomic(Unordered);
+  B.CreateCondBr(B.CreateIsNull(Cached), Resolve, Call);
+
+  B.SetInsertPoint(Resolve);
+  Value *Resolved = B.CreateCall(Resolver, {}, "resolved");
+  B.CreateAlignedStore(Resolved, Cache, Align)->setAtomic(Unordered);
+  B.CreateBr(Call);
+
+  B.SetInsertPoint(Call);
+  PHINode *Target = B.CreatePHI(FPtrTy, 2, "target");
+  Target->addIncoming(Cached, Entry);
+  Target->addIncoming(Resolved, Resolve);
+  SmallVector<Value *, 8> Args;
+  for (Argument &Arg : F.args())
+    Args.push_back(&Arg);
+  CallInst *CI = B.CreateCall(Target, Args);
+  CI->setCallingConv(F.getCallingConv());
+  // Only the return and parameter attributes describe the call. The function
+  // attributes, target-features in particular, stay on the dispatcher.
+  AttributeSet Attrs = F.getAttributes();
+  CI->setAttributes(Attrs.removeAttributes(Ctx, AttributeSet::FunctionIndex,
+                                           Attrs.getFnAttributes()));
+  CI->setTailCall();
+  if (F.getReturnType()->isVoidTy())
+    B.CreateRetVoid();
+  else
+    B.CreateRet(CI);
+}
+
+bool MultiVersioning::runOnModule(Module &M) {
+  SmallVector<Function *, 8> Worklist;
+  for (Function &F : M)
+    if (F.hasFnAttribute(VersionsAttr))
+      Worklist.push_back(&F);
+  if (Worklist.empty())
+    return false;
+
+  // Feature detection is only implemented for x86.
+  Triple T(M.getTargetTriple());
+  bool IsX86 = T.getArch() == Triple::x86 || T.getArch() == Triple::x86_64;
+
+  for (Function *F : Worklist) {
+    SmallVector<FunctionVersion, 4> Versions;
+    if (!IsX86 || F->isDeclaration() || F->isVarArg() ||
+        F->hasAvailableExternallyLinkage() || !parseVersions(*F, Versions)) {
+      DEBUG(dbgs() << "MV: not versioning " << F->getName() << "\n");
+      removeVersionsAttr(*F);
+      continue;
+    }
+
+    SmallVector<Function *, 4> Clones;
+    for (const FunctionVersion &V : Versions) {
+      std::string Suffix, Features;
+      for (StringRef Feature : V.Features) {
+        if (!Suffix.empty()) {
+          Suffix += "_";
+          Features += ",";
+        }
+        Suffix += Feature;
+        Features += "+";
+        Features += Feature;
+      }
+      Clones.push_back(cloneVersion(*F, Suffix, Features));
+      ++NumVersionClones;
+    }
+    Function *Default = cloneVersion(*F, "default", "");
+    Function *Resolver = buildResolver(*F, Versions, Clones, Default);
+    buildDispatcher(*F, Resolver);
+    ++NumMultiVersioned;
+  }
+  return true;
+}
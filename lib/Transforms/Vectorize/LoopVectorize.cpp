@@ -347,6 +347,14 @@ protected:
   /// Vectorize Load and Store instructions,
   virtual void vectorizeMemoryInstruction(Instruction *Instr);
 
+  /// Widen the non-consecutive load or store \p Instr into a masked gather
+  /// or scatter, one per unroll part.
+  void vectorizeGatherScatter(Instruction *Instr, unsigned Alignment);
+
+  /// Return a vector of pointers for each unroll part, widening the GEP that
+  /// computes \p Ptr into a vector GEP when possible.
+  VectorParts getVectorPointers(Value *Ptr);
+
   /// Create a broadcast instruction. This method generates a broadcast
   /// instruction (shuffle) for loop invariant values and for the induction
   /// value. If this is the induction variable then we extend it to N, N+1, ...
@@ -958,6 +966,26 @@ public:
   bool isLegalMaskedLoad(Type *DataType, Value *Ptr) {
     return TTI->isLegalMaskedLoad(DataType, isConsecutivePtr(Ptr));
   }
+  /// Returns true if the target machine supports masked scatter operation
+  /// for the given \p DataType.
+  bool isLegalMaskedScatter(Type *DataType) {
+    return TTI->isLegalMaskedScatter(DataType);
+  }
+  /// Returns true if the target machine supports masked gather operation
+  /// for the given \p DataType.
+  bool isLegalMaskedGather(Type *DataType) {
+    return TTI->isLegalMaskedGather(DataType);
+  }
+  /// Returns true if the non-consecutive memory access \p I can be widened
+  /// into a masked gather or scatter instead of being scalarized.
+  bool isLegalGatherOrScatter(Instruction *I) {
+    if (LoadInst *LI = dyn_cast<LoadInst>(I))
+      return !isUniform(LI->getPointerOperand()) &&
+             isLegalMaskedGather(LI->getType());
+    if (StoreInst *SI = dyn_cast<StoreInst>(I))
+      return isLegalMaskedScatter(SI->getValueOperand()->getType());
+    return false;
+  }
   /// Returns true if vector representation of the instruction \p I
   /// requires mask.
   bool isMaskRequired(const Instruction* I) {
@@ -2179,14 +2207,20 @@ void InnerLoopVectorizer::vectorizeMemoryInstruction(Instruction *Instr) {
   if (ScalarAllocatedSize != VectorElementSize)
     return scalarizeInstruction(Instr);
 
-  // If the pointer is loop invariant or if it is non-consecutive,
-  // scalarize the load.
+  // If the pointer is loop invariant scalarize the load. A non-consecutive
+  // access becomes a gather or scatter if the target supports it, and is
+  // scalarized otherwise.
   int ConsecutiveStride = Legal->isConsecutivePtr(Ptr);
   bool Reverse = ConsecutiveStride < 0;
   bool UniformLoad = LI && Legal->isUniform(Ptr);
-  if (!ConsecutiveStride || UniformLoad)
+  bool CreateGatherScatter =
+      !ConsecutiveStride && Legal->isLegalGatherOrScatter(Instr);
+  if ((!ConsecutiveStride && !CreateGatherScatter) || UniformLoad)
     return scalarizeInstruction(Instr);
 
+  if (CreateGatherScatter)
+    return vectorizeGatherScatter(Instr, Alignment);
+
   Constant *Zero = Builder.getInt32(0);
   VectorParts &Entry = WidenMap.get(Instr);
 
@@ -2312,6 +2346,69 @@ void InnerLoopVectorizer::vectorizeMemoryInstruction(Instruction *Instr) {
   }
 }
 
+InnerLoopVectorizer::VectorParts
+InnerLoopVectorizer::getVectorPointers(Value *Ptr) {
+  // Widen a GEP over sequential types into a vector GEP. Loop invariant
+  // operands are broadcast, which lets instruction selection recover a
+  // uniform base address and an index vector.
+  GetElementPtrInst *Gep = dyn_cast<GetElementPtrInst>(Ptr);
+  if (!Gep || !OrigLoop->contains(Gep))
+    return getVectorValue(Ptr);
+  for (gep_type_iterator GTI = gep_type_begin(Gep), GTE = gep_type_end(Gep);
+       GTI != GTE; ++GTI)
+    if (isa<StructType>(*GTI))
+      return getVectorValue(Ptr);
+
+  setDebugLocFromInst(Builder, Gep);
+  VectorParts Ptrs(UF);
+  VectorParts Base = getVectorValue(Gep->getPointerOperand());
+  SmallVector<VectorParts, 4> Indices;
+  for (unsigned i = 1, e = Gep->getNumOperands(); i != e; ++i)
+    Indices.push_back(getVectorValue(Gep->getOperand(i)));
+
+  for (unsigned Part = 0; Part < UF; ++Part) {
+    SmallVector<Value *, 4> Idxs;
+    for (VectorParts &Index : Indices)
+      Idxs.push_back(Index[Part]);
+    Ptrs[Part] = Builder.CreateGEP(Gep->getSourceElementType(), Base[Part],
+                                   Idxs, "vector.gep");
+  }
+  return Ptrs;
+}
+
+void InnerLoopVectorizer::vectorizeGatherScatter(Instruction *Instr,
+                                                 unsigned Alignment) {
+  LoadInst *LI = dyn_cast<LoadInst>(Instr);
+  StoreInst *SI = dyn_cast<StoreInst>(Instr);
+  Value *Ptr = LI ? LI->getPointerOperand() : SI->getPointerOperand();
+
+  VectorParts Ptrs = getVectorPointers(Ptr);
+  VectorParts Mask = createBlockInMask(Instr->getParent());
+  bool MaskRequired = Legal->isMaskRequired(Instr);
+
+  if (SI) {
+    setDebugLocFromInst(Builder, SI);
+    VectorParts StoredVal = getVectorValue(SI->getValueOperand());
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      Instruction *NewSI = Builder.CreateMaskedScatter(
+          StoredVal[Part], Ptrs[Part], Alignment,
+          MaskRequired ? Mask[Part] : nullptr);
+      propagateMetadata(NewSI, SI);
+    }
+    return;
+  }
+
+  setDebugLocFromInst(Builder, LI);
+  VectorParts &Entry = WidenMap.get(LI);
+  for (unsigned Part = 0; Part < UF; ++Part) {
+    Instruction *NewLI = Builder.CreateMaskedGather(
+        Ptrs[Part], Alignment, MaskRequired ? Mask[Part] : nullptr, nullptr,
+        "wide.masked.gather");
+    propagateMetadata(NewLI, LI);
+    Entry[Part] = NewLI;
+  }
+}
+
 void InnerLoopVectorizer::scalarizeInstruction(Instruction *Instr, bool IfPredicateStore) {
   assert(!Instr->getType()->isAggregateType() && "Can't handle vectors");
   // Holds vector parameters or scalars, in case of uniform vals.
@@ -4376,7 +4473,8 @@ bool LoopVectorizationLegality::blockCanBePredicated(BasicBlock *BB,
       if (!LI)
         return false;
       if (!SafePtrs.count(LI->getPointerOperand())) {
-        if (isLegalMaskedLoad(LI->getType(), LI->getPointerOperand())) {
+        if (isLegalMaskedLoad(LI->getType(), LI->getPointerOperand()) ||
+            isLegalMaskedGather(LI->getType())) {
           MaskedOp.insert(LI);
           continue;
         }
@@ -4401,7 +4499,8 @@ bool LoopVectorizationLegality::blockCanBePredicated(BasicBlock *BB,
         // the block.
         bool isLegalMaskedOp =
           isLegalMaskedStore(SI->getValueOperand()->getType(),
-                             SI->getPointerOperand());
+                             SI->getPointerOperand()) ||
+          isLegalMaskedScatter(SI->getValueOperand()->getType());
         if (isLegalMaskedOp) {
           --NumPredStores;
           MaskedOp.insert(SI);
@@ -5284,6 +5383,14 @@ LoopVectorizationCostModel::getInstructionCost(Instruction *I, unsigned VF) {
     const DataLayout &DL = I->getModule()->getDataLayout();
     unsigned ScalarAllocatedSize = DL.getTypeAllocSize(ValTy);
     unsigned VectorElementSize = DL.getTypeStoreSize(VectorTy) / VF;
+
+    // Gather/scatter of a non-consecutive access.
+    if (!ConsecutiveStride && ScalarAllocatedSize == VectorElementSize &&
+        Legal->isLegalGatherOrScatter(I))
+      return TTI.getAddressComputationCost(VectorTy) +
+             TTI.getGatherScatterOpCost(I->getOpcode(), VectorTy, Ptr,
+                                        Legal->isMaskRequired(I), Alignment);
+
     if (!ConsecutiveStride || ScalarAllocatedSize != VectorElementSize) {
       bool IsComplexComputation =
         isLikelyComplexAddressComputation(Ptr, Legal, SE, TheLoop);
@@ -0,0 +1,57 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=x86_64-unknown-linux-gnu -mcpu=knl | FileCheck %s --check-prefix=CHECK --check-prefix=KNL
+; RUN: opt < %s -cost-model -analyze -mtriple=x86_64-unknown-linux-gnu -mcpu=skx | FileCheck %s --check-prefix=CHECK --check-prefix=SKX
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+define void @arith() {
+  ; KNL: cost of 8 {{.*}} %mulq = mul <8 x i64>
+  ; SKX: cost of 1 {{.*}} %mulq = mul <8 x i64>
+  %mulq = mul <8 x i64> undef, undef
+  ; KNL: cost of 4 {{.*}} %mulw = mul <32 x i16>
+  ; SKX: cost of 1 {{.*}} %mulw = mul <32 x i16>
+  %mulw = mul <32 x i16> undef, undef
+  ; SKX: cost of 1 {{.*}} %shlw = shl <32 x i16>
+  %shlw = shl <32 x i16> undef, undef
+  ; CHECK: cost of 320 {{.*}} %divd = sdiv <16 x i32>
+  %divd = sdiv <16 x i32> undef, undef
+  ret void
+}
+
+define void @shuffles() {
+  ; CHECK: cost of 1 {{.*}} %revps = shufflevector
+  %revps = shufflevector <16 x float> undef, <16 x float> undef, <16 x i32> <i32 15, i32 14, i32 13, i32 12, i32 11, i32 10, i32 9, i32 8, i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  ; CHECK: cost of 1 {{.*}} %revq = shufflevector
+  %revq = shufflevector <8 x i64> undef, <8 x i64> undef, <8 x i32> <i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  ; CHECK: cost of 1 {{.*}} %altd = shufflevector
+  %altd = shufflevector <16 x i32> undef, <16 x i32> undef, <16 x i32> <i32 0, i32 17, i32 2, i32 19, i32 4, i32 21, i32 6, i32 23, i32 8, i32 25, i32 10, i32 27, i32 12, i32 29, i32 14, i32 31>
+  ret void
+}
+
+define void @casts() {
+  ; CHECK: cost of 1 {{.*}} %uitofp = uitofp <16 x i32>
+  %uitofp = uitofp <16 x i32> undef to <16 x float>
+  ; CHECK: cost of 1 {{.*}} %fptoui = fptoui <16 x float>
+  %fptoui = fptoui <16 x float> undef to <16 x i32>
+  ; CHECK: cost of 2 {{.*}} %mask = trunc <16 x i32>
+  %mask = trunc <16 x i32> undef to <16 x i1>
+  ; CHECK: cost of 1 {{.*}} %sext = sext <8 x i32>
+  %sext = sext <8 x i32> undef to <8 x i64>
+  ; SKX: cost of 1 {{.*}} %sitofpq = sitofp <8 x i64>
+  %sitofpq = sitofp <8 x i64> undef to <8 x double>
+  ; Types that are split are converted once per legal part.
+  ; CHECK: cost of 2 {{.*}} %uitofp2 = uitofp <32 x i32>
+  %uitofp2 = uitofp <32 x i32> undef to <32 x float>
+  ; SKX: cost of 2 {{.*}} %uitofpq2 = uitofp <16 x i64>
+  %uitofpq2 = uitofp <16 x i64> undef to <16 x double>
+  ; SKX: cost of 4 {{.*}} %fptosiq4 = fptosi <32 x double>
+  %fptosiq4 = fptosi <32 x double> undef to <32 x i64>
+  ret void
+}
+
+define void @selects(<16 x i1> %m, <32 x i1> %w) {
+  ; CHECK: cost of 1 {{.*}} %seld = select <16 x i1>
+  %seld = select <16 x i1> %m, <16 x i32> undef, <16 x i32> undef
+  ; SKX: cost of 1 {{.*}} %selw = select <32 x i1>
+  %selw = select <32 x i1> %w, <32 x i16> undef, <32 x i16> undef
+  ret void
+}
@@ -478,7 +478,7 @@ define <32 x float> @sitofpv32i16v32float(<32 x i16> %a) {
   ; AVX2: cost of 88 {{.*}} sitofp
   ;
   ; AVX512F: sitofpv32i16v32float
-  ; AVX512F: cost of 2 {{.*}} sitofp
+  ; AVX512F: cost of 4 {{.*}} sitofp
   %1 = sitofp <32 x i16> %a to <32 x float>
   ret <32 x float> %1
 }
@@ -558,7 +558,7 @@ define <32 x float> @sitofpv32i32v32float(<32 x i32> %a) {
   ; AVX2: cost of 88 {{.*}} sitofp
   ;
   ; AVX512F: sitofpv32i32v32float
-  ; AVX512F: cost of 1 {{.*}} sitofp
+  ; AVX512F: cost of 2 {{.*}} sitofp
   %1 = sitofp <32 x i32> %a to <32 x float>
   ret <32 x float> %1
 }
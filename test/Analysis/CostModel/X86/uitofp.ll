@@ -206,7 +206,7 @@ define <8 x double> @uitofpv8i32v8double(<8 x i32> %a) {
   ; AVX2: cost of 20 {{.*}} uitofp
   ;
   ; AVX512F: uitofpv8i32v8double
-  ; AVX512F: cost of 22 {{.*}} uitofp
+  ; AVX512F: cost of 1 {{.*}} uitofp
   %1 = uitofp <8 x i32> %a to <8 x double>
   ret <8 x double> %1
 }
@@ -542,7 +542,7 @@ define <16 x float> @uitofpv16i32v16float(<16 x i32> %a) {
   ; AVX2: cost of 44 {{.*}} uitofp
   ;
   ; AVX512F: uitofpv16i32v16float
-  ; AVX512F: cost of 46 {{.*}} uitofp
+  ; AVX512F: cost of 1 {{.*}} uitofp
   %1 = uitofp <16 x i32> %a to <16 x float>
   ret <16 x float> %1
 }
@@ -558,7 +558,7 @@ define <32 x float> @uitofpv32i32v32float(<32 x i32> %a) {
   ; AVX2: cost of 88 {{.*}} uitofp
   ;
   ; AVX512F: uitofpv32i32v32float
-  ; AVX512F: cost of 92 {{.*}} uitofp
+  ; AVX512F: cost of 2 {{.*}} uitofp
   %1 = uitofp <32 x i32> %a to <32 x float>
   ret <32 x float> %1
 }
@@ -0,0 +1,69 @@
+; RUN: opt -basicaa -loop-accesses -analyze < %s | FileCheck %s
+
+; An access whose bounds cannot be computed, like a[idx[i]], does not need a
+; run-time check when nothing else in the loop may alias it.
+;
+;   for (i = 0; i < n; i++)
+;     out[i] = a[idx[i]];
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK-LABEL: 'gather':
+; CHECK-NEXT: for.body:
+; CHECK-NEXT: Memory dependences are safe{{$}}
+; CHECK-NEXT: Interesting Dependences:
+; CHECK-NOT: Run-time memory checks:
+; CHECK: Store to invariant address was not found in loop.
+
+define void @gather(i32* noalias %out, i32* noalias %a, i32* noalias %idx, i64 %n) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %idxaddr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idxaddr, align 4
+  %j.ext = sext i32 %j to i64
+  %aaddr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %aaddr, align 4
+  %outaddr = getelementptr inbounds i32, i32* %out, i64 %i
+  store i32 %v, i32* %outaddr, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; The same pointer both read and written may conflict with itself across
+; iterations, so it still makes the loop unanalyzable.
+;
+;   for (i = 0; i < n; i++)
+;     a[idx[i]]++;
+
+; CHECK-LABEL: 'histogram':
+; CHECK-NEXT: for.body:
+; CHECK-NEXT: Report: cannot identify array bounds
+
+define void @histogram(i32* noalias %a, i32* noalias %idx, i64 %n) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %idxaddr = getelementptr inbounds i32, i32* %idx, i64 %i
+  %j = load i32, i32* %idxaddr, align 4
+  %j.ext = sext i32 %j to i64
+  %aaddr = getelementptr inbounds i32, i32* %a, i64 %j.ext
+  %v = load i32, i32* %aaddr, align 4
+  %inc = add i32 %v, 1
+  store i32 %inc, i32* %aaddr, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -146,3 +146,20 @@ define void @test_distant_memcpy(i8* %dst) {
   call void @llvm.memcpy.p0i8.p0i8.i64(i8* %dst, i8* %elem, i64 1, i32 1, i1 false)
   ret void
 }
+
+define i32 @test_bswap(i32 %a) {
+; ARM64-LABEL: test_bswap:
+; ARM64: rev w0, w0
+  %1 = call i32 @llvm.bswap.i32(i32 %a)
+  ret i32 %1
+}
+
+define i64 @test_ctlz(i64 %a) {
+; ARM64-LABEL: test_ctlz:
+; ARM64: clz x0, x0
+  %1 = call i64 @llvm.ctlz.i64(i64 %a, i1 false)
+  ret i64 %1
+}
+
+declare i32 @llvm.bswap.i32(i32)
+declare i64 @llvm.ctlz.i64(i64, i1)
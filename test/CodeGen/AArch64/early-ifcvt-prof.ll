@@ -0,0 +1,41 @@
+; RUN: llc < %s -mtriple=arm64-apple-ios -aarch64-atomic-cfg-tidy=false | FileCheck %s
+
+; Early if-conversion keeps a branch that the profile says is almost never
+; taken: it costs nothing when predicted right. The IR-level CFG tidy is
+; disabled so that it doesn't turn the branches into selects first.
+
+; CHECK-LABEL: biased:
+; CHECK: b.
+; CHECK-NOT: csel
+; CHECK: ret
+define i32 @biased(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %join, !prof !0
+
+then:
+  %x = add i32 %a, %b
+  br label %join
+
+join:
+  %r = phi i32 [ %x, %then ], [ %a, %entry ]
+  ret i32 %r
+}
+
+; CHECK-LABEL: unbiased:
+; CHECK: csel
+define i32 @unbiased(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %join
+
+then:
+  %x = add i32 %a, %b
+  br label %join
+
+join:
+  %r = phi i32 [ %x, %then ], [ %a, %entry ]
+  ret i32 %r
+}
+
+!0 = !{!"branch_weights", i32 1, i32 2000}
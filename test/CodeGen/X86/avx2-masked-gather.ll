@@ -0,0 +1,46 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mattr=+avx2 | FileCheck %s
+
+; Masked gathers are lowered to the AVX2 gather instructions. Scatters have
+; no AVX2 instruction and are scalarized by CodeGenPrepare.
+
+; A uniform base with a sign-extended 32-bit index uses the dword-index form.
+; CHECK-LABEL: gather_v8i32:
+; CHECK: vpgatherdd %ymm{{[0-9]+}}, (%rdi,%ymm{{[0-9]+}},4), %ymm{{[0-9]+}}
+define <8 x i32> @gather_v8i32(i32* %base, <8 x i32> %ind, <8 x i1> %mask, <8 x i32> %src0) {
+  %sext = sext <8 x i32> %ind to <8 x i64>
+  %splatinsert = insertelement <8 x i32*> undef, i32* %base, i32 0
+  %splat = shufflevector <8 x i32*> %splatinsert, <8 x i32*> undef, <8 x i32> zeroinitializer
+  %gep = getelementptr i32, <8 x i32*> %splat, <8 x i64> %sext
+  %res = call <8 x i32> @llvm.masked.gather.v8i32(<8 x i32*> %gep, i32 4, <8 x i1> %mask, <8 x i32> %src0)
+  ret <8 x i32> %res
+}
+
+; A plain vector of pointers is used as a qword index with a null base.
+; CHECK-LABEL: gather_v4f64:
+; CHECK: vgatherqpd %ymm{{[0-9]+}}, (,%ymm{{[0-9]+}}), %ymm{{[0-9]+}}
+define <4 x double> @gather_v4f64(<4 x double*> %ptrs, <4 x i1> %mask, <4 x double> %src0) {
+  %res = call <4 x double> @llvm.masked.gather.v4f64(<4 x double*> %ptrs, i32 8, <4 x i1> %mask, <4 x double> %src0)
+  ret <4 x double> %res
+}
+
+; 32-bit data with 64-bit pointers takes the qword-index form.
+; CHECK-LABEL: gather_v4f32:
+; CHECK: vgatherqps %xmm{{[0-9]+}}, (,%ymm{{[0-9]+}}), %xmm{{[0-9]+}}
+define <4 x float> @gather_v4f32(<4 x float*> %ptrs, <4 x i1> %mask, <4 x float> %src0) {
+  %res = call <4 x float> @llvm.masked.gather.v4f32(<4 x float*> %ptrs, i32 4, <4 x i1> %mask, <4 x float> %src0)
+  ret <4 x float> %res
+}
+
+; CHECK-LABEL: scatter_v4i32:
+; CHECK-NOT: vpscatter
+; CHECK: vpextrd $3, %xmm{{[0-9]+}}, (%r{{[a-z0-9]+}})
+; CHECK: retq
+define void @scatter_v4i32(<4 x i32> %val, <4 x i32*> %ptrs, <4 x i1> %mask) {
+  call void @llvm.masked.scatter.v4i32(<4 x i32> %val, <4 x i32*> %ptrs, i32 4, <4 x i1> %mask)
+  ret void
+}
+
+declare <8 x i32> @llvm.masked.gather.v8i32(<8 x i32*>, i32, <8 x i1>, <8 x i32>)
+declare <4 x double> @llvm.masked.gather.v4f64(<4 x double*>, i32, <4 x i1>, <4 x double>)
+declare <4 x float> @llvm.masked.gather.v4f32(<4 x float*>, i32, <4 x i1>, <4 x float>)
+declare void @llvm.masked.scatter.v4i32(<4 x i32>, <4 x i32*>, i32, <4 x i1>)
@@ -0,0 +1,31 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -stats 2>&1 | FileCheck %s --check-prefix=DEFAULT
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -stats \
+; RUN:     -large-interval-size-threshold=1 -large-interval-freq-threshold=0 \
+; RUN:     2>&1 | FileCheck %s --check-prefix=BUDGET
+; REQUIRES: asserts
+
+; With the default budget the loop-carried copies are coalesced. Once every
+; interval counts as large and its budget is used up, the coalescer leaves the
+; copies for the register allocator instead.
+
+; DEFAULT-NOT: Number of joins abandoned
+; BUDGET: regalloc - Number of joins abandoned because a large interval was joined too often
+
+define i32 @sum(i32* %p, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr inbounds i32, i32* %p, i64 %idx
+  %v = load i32, i32* %addr
+  %acc.next = add i32 %acc, %v
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret i32 %acc.next
+}
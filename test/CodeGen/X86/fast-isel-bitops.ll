@@ -0,0 +1,63 @@
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-unknown -mattr=+popcnt,+lzcnt,+bmi \
+; RUN:     -fast-isel-abort=3 -verify-machineinstrs | FileCheck %s
+
+; Bit manipulation intrinsics, memmove and assumptions are selected by
+; fast-isel without falling back to SelectionDAG.
+
+declare i32 @llvm.bswap.i32(i32)
+declare i64 @llvm.bswap.i64(i64)
+declare i32 @llvm.ctpop.i32(i32)
+declare i32 @llvm.ctlz.i32(i32, i1)
+declare i64 @llvm.cttz.i64(i64, i1)
+declare void @llvm.memmove.p0i8.p0i8.i64(i8*, i8*, i64, i32, i1)
+declare void @llvm.assume(i1)
+
+; CHECK-LABEL: test_bswap32:
+; CHECK: bswapl
+define i32 @test_bswap32(i32 %a) {
+  %1 = call i32 @llvm.bswap.i32(i32 %a)
+  ret i32 %1
+}
+
+; CHECK-LABEL: test_bswap64:
+; CHECK: bswapq
+define i64 @test_bswap64(i64 %a) {
+  %1 = call i64 @llvm.bswap.i64(i64 %a)
+  ret i64 %1
+}
+
+; CHECK-LABEL: test_ctpop32:
+; CHECK: popcntl
+define i32 @test_ctpop32(i32 %a) {
+  %1 = call i32 @llvm.ctpop.i32(i32 %a)
+  ret i32 %1
+}
+
+; CHECK-LABEL: test_ctlz32:
+; CHECK: lzcntl
+define i32 @test_ctlz32(i32 %a) {
+  %1 = call i32 @llvm.ctlz.i32(i32 %a, i1 false)
+  ret i32 %1
+}
+
+; CHECK-LABEL: test_cttz64:
+; CHECK: tzcntq
+define i64 @test_cttz64(i64 %a) {
+  %1 = call i64 @llvm.cttz.i64(i64 %a, i1 true)
+  ret i64 %1
+}
+
+; CHECK-LABEL: test_memmove:
+; CHECK: callq memmove
+define void @test_memmove(i8* %dst, i8* %src, i64 %n) {
+  call void @llvm.memmove.p0i8.p0i8.i64(i8* %dst, i8* %src, i64 %n, i32 1, i1 false)
+  ret void
+}
+
+; CHECK-LABEL: test_assume:
+; CHECK: retq
+define i32 @test_assume(i32 %a) {
+  %c = icmp sgt i32 %a, 0
+  call void @llvm.assume(i1 %c)
+  ret i32 %a
+}
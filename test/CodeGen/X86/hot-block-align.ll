@@ -0,0 +1,87 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -hot-block-align-budget=0 | FileCheck %s --check-prefix=NOPAD
+; RUN: llc < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=atom | FileCheck %s --check-prefix=NOPAD
+
+; A hot loop in a function with profile data is aligned to the 32 byte fetch
+; window, as long as that takes no more than 16 bytes of padding on top of the
+; usual loop alignment.
+
+; CHECK-LABEL: hot_loop:
+; CHECK: .align 16, 0x90
+; CHECK-NEXT: .align 32, 0x90, 16
+; CHECK-NEXT: .LBB0_
+; CHECK: jl
+
+; NOPAD-LABEL: hot_loop:
+; NOPAD-NOT: .align 32
+; NOPAD: ret
+define void @hot_loop(i32* %p, i32 %n) !prof !0 {
+entry:
+  %cmp1 = icmp sgt i32 %n, 0
+  br i1 %cmp1, label %loop, label %exit, !prof !1
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %addr = getelementptr inbounds i32, i32* %p, i32 %i
+  %v = load i32, i32* %addr
+  %v.inc = add i32 %v, 1
+  store i32 %v.inc, i32* %addr
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit, !prof !2
+
+exit:
+  ret void
+}
+
+; Without profile data the frequencies are only estimates.
+
+; CHECK-LABEL: no_profile:
+; CHECK-NOT: .align 32
+; CHECK: ret
+define void @no_profile(i32* %p, i32 %n) {
+entry:
+  %cmp1 = icmp sgt i32 %n, 0
+  br i1 %cmp1, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %addr = getelementptr inbounds i32, i32* %p, i32 %i
+  %v = load i32, i32* %addr
+  %v.inc = add i32 %v, 1
+  store i32 %v.inc, i32* %addr
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; Nor is code size spent on padding in functions optimized for size.
+
+; CHECK-LABEL: optsize:
+; CHECK-NOT: .align 32
+; CHECK: ret
+define void @optsize(i32* %p, i32 %n) optsize !prof !0 {
+entry:
+  %cmp1 = icmp sgt i32 %n, 0
+  br i1 %cmp1, label %loop, label %exit, !prof !1
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %addr = getelementptr inbounds i32, i32* %p, i32 %i
+  %v = load i32, i32* %addr
+  %v.inc = add i32 %v, 1
+  store i32 %v.inc, i32* %addr
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit, !prof !2
+
+exit:
+  ret void
+}
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 1000, i32 1}
+!2 = !{!"branch_weights", i32 100000, i32 1000}
@@ -0,0 +1,31 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=corei7 -misched-fusion=false | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=corei7 -misched-fusion=false \
+; RUN:     -x86-misched-fusion=false | FileCheck %s --check-prefix=NOFUSE
+
+; The X86 mutation keeps the compare next to the loop branch on its own,
+; without the generic macro-fusion cluster edge, so the store and the pointer
+; increment are scheduled above it.
+
+; CHECK-LABEL: fill:
+; CHECK: cmp
+; CHECK-NEXT: j
+
+; NOFUSE-LABEL: fill:
+; NOFUSE: j
+
+define void @fill(i32* %p, i64 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %addr = getelementptr inbounds i32, i32* %p, i64 %i
+  %v = trunc i64 %i to i32
+  store i32 %v, i32* %addr
+  %i.next = add i64 %i, 1
+  %cmp = icmp ult i64 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
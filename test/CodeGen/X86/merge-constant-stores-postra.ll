@@ -0,0 +1,90 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -disable-cgp-branch-opts | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -disable-cgp-branch-opts \
+; RUN:     -x86-merge-constant-stores=false | FileCheck %s --check-prefix=NOMERGE
+
+; The stores are in different IR blocks, so the selection DAG never sees them
+; together. Once branch folding has merged the blocks, they are adjacent and
+; can be combined when the wider store is naturally aligned.
+
+; CHECK-LABEL: two_bytes:
+; CHECK: movw $513, (%rdi)
+; CHECK-NEXT: retq
+
+; NOMERGE-LABEL: two_bytes:
+; NOMERGE: movb $1, (%rdi)
+; NOMERGE-NEXT: movb $2, 1(%rdi)
+
+define void @two_bytes(i8* %p) nounwind {
+entry:
+  store i8 1, i8* %p, align 2
+  br label %next
+
+next:
+  %p1 = getelementptr inbounds i8, i8* %p, i64 1
+  store i8 2, i8* %p1
+  ret void
+}
+
+; Four byte stores take two sweeps and become a single 32-bit store.
+
+; CHECK-LABEL: four_bytes:
+; CHECK: movl $67305985, 4(%rdi)
+; CHECK-NEXT: retq
+
+define void @four_bytes(i8* %p) nounwind {
+entry:
+  %p4 = getelementptr inbounds i8, i8* %p, i64 4
+  store i8 1, i8* %p4, align 4
+  br label %b1
+
+b1:
+  %p5 = getelementptr inbounds i8, i8* %p, i64 5
+  store i8 2, i8* %p5
+  br label %b2
+
+b2:
+  %p6 = getelementptr inbounds i8, i8* %p, i64 6
+  store i8 3, i8* %p6, align 2
+  br label %b3
+
+b3:
+  %p7 = getelementptr inbounds i8, i8* %p, i64 7
+  store i8 4, i8* %p7
+  ret void
+}
+
+; A 16-bit store at an odd offset would be misaligned, so the bytes stay
+; separate.
+
+; CHECK-LABEL: misaligned_bytes:
+; CHECK: movb $1, 1(%rdi)
+; CHECK-NEXT: movb $2, 2(%rdi)
+
+define void @misaligned_bytes(i8* %p) nounwind {
+entry:
+  %p1 = getelementptr inbounds i8, i8* %p, i64 1
+  store i8 1, i8* %p1
+  br label %next
+
+next:
+  %p2 = getelementptr inbounds i8, i8* %p, i64 2
+  store i8 2, i8* %p2, align 2
+  ret void
+}
+
+; Volatile stores are left alone.
+
+; CHECK-LABEL: volatile_bytes:
+; CHECK: movb $1, (%rdi)
+; CHECK-NEXT: movb $2, 1(%rdi)
+
+define void @volatile_bytes(i8* %p) nounwind {
+entry:
+  store volatile i8 1, i8* %p, align 2
+  br label %next
+
+next:
+  %p1 = getelementptr inbounds i8, i8* %p, i64 1
+  store volatile i8 2, i8* %p1
+  ret void
+}
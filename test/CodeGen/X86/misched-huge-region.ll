@@ -0,0 +1,72 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=core2 -enable-misched \
+; RUN:     -verify-machineinstrs -verify-misched -debug-only=misched \
+; RUN:     -o /dev/null 2>&1 | FileCheck %s --check-prefix=NOLIMIT
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=core2 -enable-misched \
+; RUN:     -dag-maps-huge-region=4 -verify-machineinstrs -verify-misched \
+; RUN:     -debug-only=misched -stats -o /dev/null 2>&1 | FileCheck %s
+;
+; The stores all go to different globals, so normally there are no chain
+; dependencies between them at all.
+;
+; NOLIMIT-NOT: Reducing
+; NOLIMIT: Memory chain dependencies: 0 for 20 SUnits
+;
+; With a tiny dag-maps-huge-region the maps are reduced every four stores,
+; walking the block bottom-up. The topmost store of each dropped group becomes
+; the barrier chain: the rest of the group and the previous barrier chain are
+; ordered after it, and every store above it before it.
+;
+; CHECK: Reducing 4 memory nodes at SU(13)
+; CHECK-NEXT: Reducing 4 memory nodes at SU(9)
+; CHECK-NEXT: Reducing 4 memory nodes at SU(5)
+; CHECK-NEXT: Reducing 4 memory nodes at SU(1)
+; CHECK-NEXT: Memory chain dependencies: 13 for 20 SUnits
+;
+; CHECK: SU(9): MOV32mr {{.*}}mem:ST4[@g4]
+; CHECK: Predecessors:
+; CHECK-NEXT: val SU(8)
+; CHECK-NEXT: ch SU(3)
+; CHECK-NEXT: ch SU(1)
+; CHECK-NEXT: ch SU(5)
+; CHECK-NEXT: Successors:
+; CHECK-NEXT: ch SU(17)
+; CHECK-NEXT: ch SU(13)
+; CHECK-NEXT: ch SU(11)
+;
+; CHECK: misched - Number of times memory node maps were reduced in huge regions
+
+@g0 = global i32 0
+@g1 = global i32 0
+@g2 = global i32 0
+@g3 = global i32 0
+@g4 = global i32 0
+@g5 = global i32 0
+@g6 = global i32 0
+@g7 = global i32 0
+@g8 = global i32 0
+@g9 = global i32 0
+
+define void @stores(i32 %x) {
+entry:
+  store i32 %x, i32* @g0
+  %x1 = add i32 %x, 1
+  store i32 %x1, i32* @g1
+  %x2 = add i32 %x, 2
+  store i32 %x2, i32* @g2
+  %x3 = add i32 %x, 3
+  store i32 %x3, i32* @g3
+  %x4 = add i32 %x, 4
+  store i32 %x4, i32* @g4
+  %x5 = add i32 %x, 5
+  store i32 %x5, i32* @g5
+  %x6 = add i32 %x, 6
+  store i32 %x6, i32* @g6
+  %x7 = add i32 %x, 7
+  store i32 %x7, i32* @g7
+  %x8 = add i32 %x, 8
+  store i32 %x8, i32* @g8
+  %x9 = add i32 %x, 9
+  store i32 %x9, i32* @g9
+  ret void
+}
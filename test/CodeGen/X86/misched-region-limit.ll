@@ -0,0 +1,39 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=core2 -enable-misched \
+; RUN:     -misched-region-limit=4 -verify-machineinstrs -verify-misched \
+; RUN:     -debug-only=misched -o /dev/null 2>&1 | FileCheck %s
+;
+; A straight-line block is cut into scheduling regions of at most four
+; instructions.
+
+; CHECK: MI Scheduling
+; CHECK: RegionInstrs: {{[1-4]}} Remaining:
+; CHECK-NOT: RegionInstrs: {{[5-9]|[1-9][0-9]}} Remaining:
+
+define i32 @sum(i32* %p) {
+entry:
+  %a0 = getelementptr i32, i32* %p, i64 0
+  %a1 = getelementptr i32, i32* %p, i64 1
+  %a2 = getelementptr i32, i32* %p, i64 2
+  %a3 = getelementptr i32, i32* %p, i64 3
+  %a4 = getelementptr i32, i32* %p, i64 4
+  %a5 = getelementptr i32, i32* %p, i64 5
+  %a6 = getelementptr i32, i32* %p, i64 6
+  %a7 = getelementptr i32, i32* %p, i64 7
+  %v0 = load i32, i32* %a0
+  %v1 = load i32, i32* %a1
+  %v2 = load i32, i32* %a2
+  %v3 = load i32, i32* %a3
+  %v4 = load i32, i32* %a4
+  %v5 = load i32, i32* %a5
+  %v6 = load i32, i32* %a6
+  %v7 = load i32, i32* %a7
+  %m0 = mul i32 %v0, %v1
+  %m1 = mul i32 %v2, %v3
+  %m2 = mul i32 %v4, %v5
+  %m3 = mul i32 %v6, %v7
+  %s0 = add i32 %m0, %m1
+  %s1 = add i32 %m2, %m3
+  %s = add i32 %s0, %s1
+  ret i32 %s
+}
@@ -0,0 +1,97 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=corei7 | FileCheck %s
+
+; A select whose condition is heavily biased is turned into a branch, which
+; will be predicted right nearly every time.
+
+; CHECK-LABEL: biased:
+; CHECK-NOT: cmov
+; CHECK: j
+; CHECK: retq
+define i32 @biased(i32 %a, i32 %b, i32 %x, i32 %y) {
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 %y, !prof !0
+  ret i32 %r
+}
+
+; Without a profile, or with a balanced one, the select stays a cmov.
+
+; CHECK-LABEL: balanced:
+; CHECK: cmov
+define i32 @balanced(i32 %a, i32 %b, i32 %x, i32 %y) {
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 %y, !prof !1
+  ret i32 %r
+}
+
+; A compare of a loaded value would normally become a branch so the
+; processor need not wait for the load. An unpredictable select stays a cmov.
+
+; CHECK-LABEL: load_cmp:
+; CHECK-NOT: cmov
+; CHECK: retq
+define i32 @load_cmp(i32* %p, i32 %b, i32 %x, i32 %y) {
+  %a = load i32, i32* %p
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 %y
+  ret i32 %r
+}
+
+; CHECK-LABEL: load_cmp_unpredictable:
+; CHECK: cmov
+define i32 @load_cmp_unpredictable(i32* %p, i32 %b, i32 %x, i32 %y) {
+  %a = load i32, i32* %p
+  %c = icmp slt i32 %a, %b
+  %r = select i1 %c, i32 %x, i32 %y, !unpredictable !2
+  ret i32 %r
+}
+
+; An unpredictable branch is if-converted into a cmov even though early
+; if-conversion is otherwise disabled on X86.
+
+; CHECK-LABEL: branch_unpredictable:
+; CHECK-NOT: j
+; CHECK: cmov
+; CHECK: retq
+define i32 @branch_unpredictable(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %else, !unpredictable !2
+
+then:
+  %x = add i32 %a, 7
+  br label %join
+
+else:
+  %y = xor i32 %b, 12
+  br label %join
+
+join:
+  %r = phi i32 [ %x, %then ], [ %y, %else ]
+  ret i32 %r
+}
+
+; CHECK-LABEL: branch:
+; CHECK: j
+; CHECK-NOT: cmov
+; CHECK: retq
+define i32 @branch(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %else
+
+then:
+  %x = add i32 %a, 7
+  br label %join
+
+else:
+  %y = xor i32 %b, 12
+  br label %join
+
+join:
+  %r = phi i32 [ %x, %then ], [ %y, %else ]
+  ret i32 %r
+}
+
+!0 = !{!"branch_weights", i32 2000, i32 1}
+!1 = !{!"branch_weights", i32 50, i32 50}
+!2 = !{}
@@ -0,0 +1,86 @@
+; REQUIRES: object-emission
+
+; RUN: llc -split-dwarf=Enable -filetype=obj -O0 -generate-type-units -mtriple=x86_64-unknown-linux-gnu < %s \
+; RUN:     | llvm-dwarfdump - | FileCheck %s
+
+; Two CUs, as after linking, that both use a type that cannot go in a type
+; unit because it references an address, and a type that can. The first kind
+; is built directly in each CU, the second is shared by both.
+
+; Test case built from:
+;// a.cpp
+;int i;
+;template <int *I>
+;struct S1 {};
+;struct P {};
+;S1<&i> a;
+;P p1;
+;
+;// b.cpp
+;extern int i;
+;template <int *I>
+;struct S1 {};
+;struct P {};
+;S1<&i> b;
+;P p2;
+
+; CHECK: .debug_info.dwo contents:
+
+; CHECK: DW_TAG_compile_unit
+; CHECK: DW_AT_name {{.*}}"a.cpp"
+; CHECK: DW_TAG_structure_type
+; CHECK-NEXT: DW_AT_name {{.*}}"S1<&i>"
+; CHECK: DW_TAG_structure_type
+; CHECK-NEXT: DW_AT_declaration
+; CHECK-NEXT: DW_AT_signature [DW_FORM_ref_sig8] ([[P_SIG:0x[0-9a-f]*]])
+
+; CHECK: DW_TAG_compile_unit
+; CHECK: DW_AT_name {{.*}}"b.cpp"
+; CHECK: DW_TAG_structure_type
+; CHECK-NEXT: DW_AT_name {{.*}}"S1<&i>"
+; CHECK: DW_TAG_structure_type
+; CHECK-NEXT: DW_AT_declaration
+; CHECK-NEXT: DW_AT_signature [DW_FORM_ref_sig8] ([[P_SIG]])
+
+; CHECK: .debug_types.dwo contents:
+; CHECK-NOT: DW_AT_name {{.*}}"S1<&i>"
+; CHECK: type_signature = [[P_SIG]]
+; CHECK-NOT: type_signature
+; CHECK-NOT: DW_AT_name {{.*}}"S1<&i>"
+; CHECK: .debug_line.dwo contents:
+
+%struct.S1 = type { i8 }
+%struct.P = type { i8 }
+
+@i = global i32 0, align 4
+@a = global %struct.S1 zeroinitializer, align 1
+@p1 = global %struct.P zeroinitializer, align 1
+@b = global %struct.S1 zeroinitializer, align 1
+@p2 = global %struct.P zeroinitializer, align 1
+
+!llvm.dbg.cu = !{!0, !15}
+!llvm.module.flags = !{!21, !22}
+!llvm.ident = !{!23}
+
+!0 = !DICompileUnit(language: DW_LANG_C_plus_plus, producer: "clang version 3.7.0 ", isOptimized: false, splitDebugFilename: "a.dwo", emissionKind: 1, file: !1, enums: !2, retainedTypes: !3, subprograms: !2, globals: !10, imports: !2)
+!1 = !DIFile(filename: "a.cpp", directory: "/tmp/dbginfo")
+!2 = !{}
+!3 = !{!4, !9}
+!4 = !DICompositeType(tag: DW_TAG_structure_type, name: "S1<&i>", line: 3, size: 8, align: 8, file: !1, elements: !2, templateParams: !5, identifier: "_ZTS2S1IXadL_Z1iEEE")
+!5 = !{!6}
+!6 = !DITemplateValueParameter(tag: DW_TAG_template_value_parameter, name: "I", type: !7, value: i32* @i)
+!7 = !DIDerivedType(tag: DW_TAG_pointer_type, size: 64, align: 64, baseType: !8)
+!8 = !DIBasicType(tag: DW_TAG_base_type, name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!9 = !DICompositeType(tag: DW_TAG_structure_type, name: "P", line: 4, size: 8, align: 8, file: !1, elements: !2, identifier: "_ZTS1P")
+!10 = !{!11, !12, !13}
+!11 = !DIGlobalVariable(name: "i", line: 1, isLocal: false, isDefinition: true, scope: null, file: !1, type: !8, variable: i32* @i)
+!12 = !DIGlobalVariable(name: "a", line: 5, isLocal: false, isDefinition: true, scope: null, file: !1, type: !"_ZTS2S1IXadL_Z1iEEE", variable: %struct.S1* @a)
+!13 = !DIGlobalVariable(name: "p1", line: 6, isLocal: false, isDefinition: true, scope: null, file: !1, type: !"_ZTS1P", variable: %struct.P* @p1)
+!15 = !DICompileUnit(language: DW_LANG_C_plus_plus, producer: "clang version 3.7.0 ", isOptimized: false, splitDebugFilename: "b.dwo", emissionKind: 1, file: !16, enums: !2, retainedTypes: !3, subprograms: !2, globals: !17, imports: !2)
+!16 = !DIFile(filename: "b.cpp", directory: "/tmp/dbginfo")
+!17 = !{!18, !19}
+!18 = !DIGlobalVariable(name: "b", line: 5, isLocal: false, isDefinition: true, scope: null, file: !16, type: !"_ZTS2S1IXadL_Z1iEEE", variable: %struct.S1* @b)
+!19 = !DIGlobalVariable(name: "p2", line: 6, isLocal: false, isDefinition: true, scope: null, file: !16, type: !"_ZTS1P", variable: %struct.P* @p2)
+!21 = !{i32 2, !"Dwarf Version", i32 4}
+!22 = !{i32 1, !"Debug Info Version", i32 3}
+!23 = !{!"clang version 3.7.0 "}
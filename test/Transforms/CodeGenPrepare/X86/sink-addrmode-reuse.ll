@@ -0,0 +1,32 @@
+; RUN: opt -S -codegenprepare < %s | FileCheck %s
+; RUN: opt -S -codegenprepare -cgp-huge-func=1 < %s | FileCheck %s
+; RUN: opt -S -codegenprepare -stats < %s 2>&1 | FileCheck %s --check-prefix=STATS
+; REQUIRES: asserts
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The address is sunk into %then once and both loads use the same copy.
+; CHECK-LABEL: @reuse(
+; CHECK: then:
+; CHECK: [[ADDR:%sunkaddr[0-9]*]] = inttoptr i64 {{%sunkaddr[0-9]*}} to i32*
+; CHECK-NEXT: load i32, i32* [[ADDR]]
+; CHECK-NEXT: load i32, i32* [[ADDR]]
+; CHECK-NOT: sunkaddr
+; CHECK: ret i32
+define i32 @reuse(i32* %p, i1 %c) {
+entry:
+  %a = getelementptr inbounds i32, i32* %p, i64 8
+  br i1 %c, label %then, label %exit
+
+then:
+  %v1 = load i32, i32* %a
+  %v2 = load i32, i32* %a
+  %s = add i32 %v1, %v2
+  ret i32 %s
+
+exit:
+  ret i32 0
+}
+
+; STATS: 1 codegenprepare - Number of memory instructions that reused an address already sunk into their block
@@ -0,0 +1,59 @@
+; RUN: opt < %s -loop-vectorize -force-vector-interleave=1 -mcpu=skx -S | FileCheck %s --check-prefix=ZMM
+; RUN: opt < %s -loop-vectorize -force-vector-interleave=1 -mcpu=skx -x86-prefer-vector-width=256 -S | FileCheck %s --check-prefix=YMM
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; By default AVX-512 targets vectorize with 512-bit vectors. Capping the
+; preferred width, globally or per function, keeps the loop on 256-bit
+; vectors to avoid the lower turbo frequency of heavy 512-bit code.
+
+; ZMM-LABEL: @scale(
+; ZMM: fmul <16 x float>
+; YMM-LABEL: @scale(
+; YMM: fmul <8 x float>
+; YMM-NOT: <16 x float>
+define void @scale(float* noalias %a, float* noalias %b, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pb = getelementptr inbounds float, float* %b, i64 %i
+  %v = load float, float* %pb, align 4
+  %m = fmul float %v, 3.000000e+00
+  %pa = getelementptr inbounds float, float* %a, i64 %i
+  store float %m, float* %pa, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; ZMM-LABEL: @scale_256(
+; ZMM: fmul <8 x float>
+; ZMM-NOT: <16 x float>
+; YMM-LABEL: @scale_256(
+; YMM: fmul <8 x float>
+define void @scale_256(float* noalias %a, float* noalias %b, i64 %n) #0 {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pb = getelementptr inbounds float, float* %b, i64 %i
+  %v = load float, float* %pb, align 4
+  %m = fmul float %v, 3.000000e+00
+  %pa = getelementptr inbounds float, float* %a, i64 %i
+  store float %m, float* %pa, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+attributes #0 = { "prefer-vector-width"="256" }
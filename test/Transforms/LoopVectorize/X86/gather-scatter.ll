@@ -0,0 +1,95 @@
+; RUN: opt < %s -basicaa -loop-vectorize -force-vector-width=8 -force-vector-interleave=1 -mattr=+avx2 -S | FileCheck %s --check-prefix=AVX2
+; RUN: opt < %s -basicaa -loop-vectorize -force-vector-width=8 -force-vector-interleave=1 -mattr=+avx512f -S | FileCheck %s --check-prefix=AVX512
+; RUN: opt < %s -basicaa -loop-vectorize -force-vector-width=8 -force-vector-interleave=1 -mattr=+avx -S | FileCheck %s --check-prefix=AVX1
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Indexed loads become masked gathers when the target has them, and are
+; scalarized otherwise.
+;
+; void gather(int *restrict out, int *restrict a, int *restrict idx, int n) {
+;   for (int i = 0; i < n; i++)
+;     out[i] = a[idx[i]];
+; }
+
+; AVX2-LABEL: @gather(
+; AVX2: %[[GEP:.*]] = getelementptr i32, <8 x i32*> %{{.*}}, <8 x i64> %{{.*}}
+; AVX2: call <8 x i32> @llvm.masked.gather.v8i32(<8 x i32*> %[[GEP]], i32 4, <8 x i1> <i1 true, i1 true, i1 true, i1 true, i1 true, i1 true, i1 true, i1 true>, <8 x i32> undef)
+; AVX512-LABEL: @gather(
+; AVX512: call <8 x i32> @llvm.masked.gather.v8i32
+; AVX1-LABEL: @gather(
+; AVX1-NOT: llvm.masked.gather
+; AVX1: ret void
+define void @gather(i32* noalias %out, i32* noalias %a, i32* noalias %idx, i32 %n) {
+entry:
+  %cmp6 = icmp sgt i32 %n, 0
+  br i1 %cmp6, label %for.body, label %for.end
+
+for.body:
+  %indvars.iv = phi i64 [ %indvars.iv.next, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %idx, i64 %indvars.iv
+  %0 = load i32, i32* %arrayidx, align 4
+  %idxprom1 = sext i32 %0 to i64
+  %arrayidx2 = getelementptr inbounds i32, i32* %a, i64 %idxprom1
+  %1 = load i32, i32* %arrayidx2, align 4
+  %arrayidx4 = getelementptr inbounds i32, i32* %out, i64 %indvars.iv
+  store i32 %1, i32* %arrayidx4, align 4
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %lftr.wideiv = trunc i64 %indvars.iv.next to i32
+  %exitcond = icmp eq i32 %lftr.wideiv, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; A predicated indexed load gets the block mask, and a predicated indexed
+; store needs a scatter. AVX2 has none, so the loop stays scalar there.
+;
+; void scatter(float *restrict out, float *restrict in, int *restrict idx,
+;              int *restrict trigger, int n) {
+;   for (int i = 0; i < n; i++)
+;     if (trigger[i] > 0)
+;       out[idx[i]] = in[idx[i]] + 1.0f;
+; }
+
+; AVX2-LABEL: @scatter(
+; AVX2-NOT: llvm.masked
+; AVX2: ret void
+; AVX512-LABEL: @scatter(
+; AVX512: %{{.*}} = icmp sgt <8 x i32> %{{.*}}, zeroinitializer
+; AVX512: call <8 x float> @llvm.masked.gather.v8f32(<8 x float*> %{{.*}}, i32 4, <8 x i1> %{{.*}}, <8 x float> undef)
+; AVX512: call void @llvm.masked.scatter.v8f32(<8 x float> %{{.*}}, <8 x float*> %{{.*}}, i32 4, <8 x i1> %{{.*}})
+define void @scatter(float* noalias %out, float* noalias %in, i32* noalias %idx, i32* noalias %trigger, i32 %n) {
+entry:
+  %cmp12 = icmp sgt i32 %n, 0
+  br i1 %cmp12, label %for.body, label %for.end
+
+for.body:
+  %indvars.iv = phi i64 [ %indvars.iv.next, %for.inc ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %trigger, i64 %indvars.iv
+  %0 = load i32, i32* %arrayidx, align 4
+  %cmp1 = icmp sgt i32 %0, 0
+  br i1 %cmp1, label %if.then, label %for.inc
+
+if.then:
+  %arrayidx3 = getelementptr inbounds i32, i32* %idx, i64 %indvars.iv
+  %1 = load i32, i32* %arrayidx3, align 4
+  %idxprom4 = sext i32 %1 to i64
+  %arrayidx5 = getelementptr inbounds float, float* %in, i64 %idxprom4
+  %2 = load float, float* %arrayidx5, align 4
+  %add = fadd float %2, 1.000000e+00
+  %arrayidx8 = getelementptr inbounds float, float* %out, i64 %idxprom4
+  store float %add, float* %arrayidx8, align 4
+  br label %for.inc
+
+for.inc:
+  %indvars.iv.next = add nuw nsw i64 %indvars.iv, 1
+  %lftr.wideiv = trunc i64 %indvars.iv.next to i32
+  %exitcond = icmp eq i32 %lftr.wideiv, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -276,11 +276,13 @@ for.end:                                          ; preds = %for.cond
 ;}
 
 ;AVX2-LABEL: @foo4
-;AVX2-NOT: llvm.masked
+;AVX2: call <4 x double> @llvm.masked.gather.v4f64
+;AVX2: call void @llvm.masked.store.v4f64
 ;AVX2: ret void
 
 ;AVX512-LABEL: @foo4
-;AVX512-NOT: llvm.masked
+;AVX512: call <8 x double> @llvm.masked.gather.v8f64
+;AVX512: call void @llvm.masked.store.v8f64
 ;AVX512: ret void
 
 ; Function Attrs: nounwind uwtable
@@ -0,0 +1,36 @@
+; RUN: opt -S -multiversion < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The dispatcher keeps the linkage of the function it replaces, and the call
+; to the selected version only carries its return and parameter attributes.
+
+; CHECK-LABEL: define internal signext i8 @local(i8* nocapture %p)
+; CHECK: tail call signext i8 %target(i8* nocapture %p){{$}}
+define internal signext i8 @local(i8* nocapture %p) #0 {
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: define linkonce_odr i32 @inline_fn(i32 %x)
+; CHECK: tail call i32 %target(i32 %x){{$}}
+define linkonce_odr i32 @inline_fn(i32 %x) #0 {
+  %r = mul i32 %x, 3
+  ret i32 %r
+}
+
+; CHECK-LABEL: define weak void @weak_fn()
+; CHECK: load atomic void ()*, void ()** @weak_fn.resolved unordered, align 8
+; CHECK: store atomic void ()* %resolved, void ()** @weak_fn.resolved unordered, align 8
+; CHECK: tail call void %target(){{$}}
+define weak void @weak_fn() #0 {
+  ret void
+}
+
+define i8 @use(i8* %p) {
+  %v = call signext i8 @local(i8* %p)
+  ret i8 %v
+}
+
+attributes #0 = { nounwind "target-features"="+sse2" "target-versions"="avx2" }
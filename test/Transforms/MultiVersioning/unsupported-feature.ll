@@ -0,0 +1,8 @@
+; RUN: not opt -S -multiversion < %s 2>&1 | FileCheck %s
+
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: error: function 'f' requests unsupported target version feature 'sha'
+define void @f() "target-versions"="sha" {
+  ret void
+}
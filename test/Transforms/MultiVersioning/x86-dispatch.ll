@@ -0,0 +1,55 @@
+; RUN: opt -S -multiversion < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: @__cpu_model = external global { i32, i32, i32, [1 x i32] }
+; CHECK: @sum.resolved = internal global i32 (i32*, i32)* null, align 8
+
+; The original symbol becomes the dispatcher.
+; CHECK-LABEL: define i32 @sum(i32* %p, i32 %n)
+; CHECK: %cached = load atomic i32 (i32*, i32)*, i32 (i32*, i32)** @sum.resolved unordered, align 8
+; CHECK: resolve:
+; CHECK-NEXT: %resolved = call i32 (i32*, i32)* @sum.resolver()
+; CHECK-NEXT: store atomic i32 (i32*, i32)* %resolved, i32 (i32*, i32)** @sum.resolved unordered, align 8
+; CHECK: call:
+; CHECK: %[[R:.*]] = tail call i32 %target(i32* %p, i32 %n){{$}}
+; CHECK-NEXT: ret i32 %[[R]]
+define i32 @sum(i32* %p, i32 %n) #0 {
+entry:
+  %v = load i32, i32* %p
+  %r = add i32 %v, %n
+  ret i32 %r
+}
+
+; Functions without the attribute are left alone.
+; CHECK-LABEL: define i32 @plain(
+; CHECK-NEXT: ret i32 0
+define i32 @plain() {
+  ret i32 0
+}
+
+; CHECK-LABEL: define internal i32 @sum.avx2_fma(
+; CHECK-SAME: i32* %p, i32 %n) #[[AVX2:[0-9]+]]
+; CHECK: add i32
+; CHECK-LABEL: define internal i32 @sum.sse4.2(
+; CHECK-SAME: i32* %p, i32 %n) #[[SSE42:[0-9]+]]
+; CHECK-LABEL: define internal i32 @sum.default(
+; CHECK-SAME: i32* %p, i32 %n) #[[DEF:[0-9]+]]
+
+; Versions are tried in the order given, falling back to the default clone.
+; CHECK-LABEL: define internal i32 (i32*, i32)* @sum.resolver()
+; CHECK: call void @__cpu_indicator_init()
+; CHECK: %cpu.features = load i32, i32* getelementptr inbounds ({ i32, i32, i32, [1 x i32] }, { i32, i32, i32, [1 x i32] }* @__cpu_model, i32 0, i32 3, i32 0)
+; CHECK: and i32 %cpu.features, 17408
+; CHECK: ret i32 (i32*, i32)* @sum.avx2_fma
+; CHECK: and i32 %cpu.features, 256
+; CHECK: ret i32 (i32*, i32)* @sum.sse4.2
+; CHECK: ret i32 (i32*, i32)* @sum.default
+
+attributes #0 = { nounwind "target-features"="+sse2" "target-versions"="avx2,fma;sse4.2" }
+
+; CHECK-NOT: target-versions
+; CHECK-DAG: attributes #[[AVX2]] = { nounwind "target-features"="+sse2,+avx2,+fma" }
+; CHECK-DAG: attributes #[[SSE42]] = { nounwind "target-features"="+sse2,+sse4.2" }
+; CHECK-DAG: attributes #[[DEF]] = { nounwind "target-features"="+sse2" }
@@ -0,0 +1,16 @@
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=haswell -iterations=10 %s \
+# RUN:   | FileCheck %s
+
+# Each addition depends on the previous one, so the block runs at one
+# instruction per cycle even though four ALU ports are available.
+
+addl %eax, %eax
+addl %eax, %eax
+addl %eax, %eax
+
+# CHECK:      Iterations:        10
+# CHECK-NEXT: Instructions:      30
+# CHECK-NEXT: Total Cycles:      31
+# CHECK:      IPC:               0.97
+# CHECK:      Block RThroughput: 0.75
+# CHECK:      Bottleneck:        dependency chain (latency bound)
@@ -0,0 +1,19 @@
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=haswell %s | FileCheck %s
+
+# Three independent additions fit in the four ALU ports every cycle.
+
+addl %eax, %ebx
+addl %ecx, %edx
+addl %esi, %edi
+
+# CHECK:      Iterations:        100
+# CHECK-NEXT: Instructions:      300
+# CHECK:      Dispatch Width:    4
+# CHECK:      Block RThroughput: 0.75
+# CHECK:      Bottleneck:        resource pressure on
+# CHECK:      Resource pressure per iteration:
+# CHECK:      units 4  cycles 3.00
+# CHECK:      Instruction Info:
+# CHECK:      1      1      addl %eax, %ebx
+# CHECK-NEXT: 1      1      addl %ecx, %edx
+# CHECK-NEXT: 1      1      addl %esi, %edi
@@ -0,0 +1,13 @@
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=skx %s | FileCheck %s
+
+# Skylake Server runs FP add, multiply and FMA on the same 4-cycle pipes.
+
+vaddps %ymm0, %ymm1, %ymm2
+vmulps %ymm0, %ymm1, %ymm3
+vaddps %zmm0, %zmm1, %zmm4
+
+# CHECK:      Dispatch Width:    6
+# CHECK:      Instruction Info:
+# CHECK:      1      4      vaddps %ymm0, %ymm1, %ymm2
+# CHECK-NEXT: 1      4      vmulps %ymm0, %ymm1, %ymm3
+# CHECK-NEXT: 1      4      vaddps %zmm0, %zmm1, %zmm4
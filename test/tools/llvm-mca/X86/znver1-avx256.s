@@ -0,0 +1,12 @@
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=znver1 %s | FileCheck %s
+
+# The FP pipes on Zen are 128 bits wide, so 256-bit operations are split in
+# two micro-ops.
+
+vaddps %xmm0, %xmm1, %xmm2
+vaddps %ymm0, %ymm1, %ymm3
+
+# CHECK:      Dispatch Width:    6
+# CHECK:      Instruction Info:
+# CHECK:      1      3      vaddps %xmm0, %xmm1, %xmm2
+# CHECK-NEXT: 2      3      vaddps %ymm0, %ymm1, %ymm3
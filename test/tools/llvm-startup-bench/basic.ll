@@ -0,0 +1,21 @@
+; Timings vary from run to run, so only check the shape of the report.
+
+; RUN: llvm-startup-bench -runs=2 llc -- -o /dev/null %s | FileCheck %s
+; CHECK: ; llc, 2 runs, wall time in ms
+; CHECK-NEXT: ; command      min   median      max
+; CHECK-NEXT: exec
+; CHECK-NEXT: main
+; CHECK-NEXT: compile
+
+; RUN: llvm-startup-bench -runs=1 llc | FileCheck %s --check-prefix=NOCOMPILE
+; NOCOMPILE: main
+; NOCOMPILE-NOT: compile
+
+; RUN: not llvm-startup-bench -runs=1 llc -- -no-such-option 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=FAIL
+; FAIL: compile   failed
+
+define i32 @f(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
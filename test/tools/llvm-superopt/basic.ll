@@ -0,0 +1,60 @@
+; RUN: llvm-superopt %s | FileCheck %s
+; RUN: llvm-superopt -show-all %s | FileCheck %s --check-prefix=ALL
+
+; Single instructions, and values with more than one use, are not part of a
+; sequence. The two copies of the same sequence are counted together and
+; reported first. With 16 bits of input it is verified exhaustively.
+
+; CHECK: ; 2 occurrences, 2 instructions -> 0 (exhaustive)
+; CHECK-NEXT: (and i8 (or i8 %0:i8, %1:i8), %0:i8)
+; CHECK-NEXT:   => %0:i8
+
+; CHECK: ; 1 occurrence, 2 instructions -> 0 (random)
+; CHECK-NEXT: (sub i32 (add i32 %0:i32, %1:i32), %1:i32)
+; CHECK-NEXT:   => %0:i32
+
+; CHECK-NOT: xor
+; CHECK: ; 3 distinct sequences, 4 occurrences, 2 with a cheaper replacement
+
+; ALL: ; 1 occurrence, 2 instructions
+; ALL-NEXT: (and i8 (xor i8 %0:i8, -1), %1:i8)
+; ALL-NOT: =>
+; ALL: ; 1 occurrence, 2 instructions -> 0 (random)
+
+define i8 @absorb1(i8 %x, i8 %y) {
+  %o = or i8 %x, %y
+  %a = and i8 %o, %x
+  ret i8 %a
+}
+
+define i8 @absorb2(i8 %p, i8 %q) {
+  %o = or i8 %p, %q
+  %a = and i8 %o, %p
+  ret i8 %a
+}
+
+define i32 @addsub(i32 %x, i32 %y) {
+  %s = add i32 %x, %y
+  %d = sub i32 %s, %y
+  ret i32 %d
+}
+
+define i8 @andnot(i8 %x, i8 %y) {
+  %n = xor i8 %x, -1
+  %a = and i8 %n, %y
+  ret i8 %a
+}
+
+define i32 @loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, 1
+  %c = icmp ult i32 %i.next, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %i.next
+}
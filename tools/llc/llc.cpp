@@ -184,14 +184,16 @@ int main(int argc, char **argv) {
   InitializeAllAsmPrinters();
   InitializeAllAsmParsers();
 
-  // Initialize codegen and IR passes used by llc so that the -print-after,
-  // -print-before, and -stop-after options work.
+  // Make the codegen and IR passes used by llc known so that the -print-after,
+  // -print-before, and -stop-after options work. They are only registered
+  // when one of them is first looked up, which keeps them off the startup
+  // path.
   PassRegistry *Registry = PassRegistry::getPassRegistry();
-  initializeCore(*Registry);
-  initializeCodeGen(*Registry);
-  initializeLoopStrengthReducePass(*Registry);
-  initializeLowerIntrinsicsPass(*Registry);
-  initializeUnreachableBlockElimPass(*Registry);
+  Registry->addDeferredInitializer(initializeCore);
+  Registry->addDeferredInitializer(initializeCodeGen);
+  Registry->addDeferredInitializer(initializeLoopStrengthReducePass);
+  Registry->addDeferredInitializer(initializeLowerIntrinsicsPass);
+  Registry->addDeferredInitializer(initializeUnreachableBlockElimPass);
 
   // Register the target printer for --version.
   cl::AddExtraVersionPrinter(TargetRegistry::printRegisteredTargetsForVersion);
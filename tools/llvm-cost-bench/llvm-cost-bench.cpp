@@ -0,0 +1,462 @@
+//===-- llvm-cost-bench.cpp - Validate TTI costs against the host ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program measures the reciprocal throughput of arithmetic instructions
+// on the host and compares it with the cost TargetTransformInfo assigns to
+// them.
+//
+// For every (opcode, element type, vector width) it generates a micro-kernel
+//
+//   loop:
+//     acc0 = op acc0, c
+//     acc1 = op acc1, c
+//     ...
+//
+// with several independent accumulators, so that the loop is bound by
+// throughput rather than latency. The kernel is compiled for the host CPU
+// with MCJIT and timed with the cycle counter (llvm.readcyclecounter) on x86
+// hosts, and with the wall clock elsewhere.
+//
+// TTI costs are relative units, so the report first derives the number of
+// cycles per cost unit as the median ratio over all kernels. A kernel is
+// flagged when its measured throughput is off from its scaled cost by more
+// than -tolerance. More importantly for the vectorizers, a vector kernel is
+// flagged when the model and the measurement disagree about whether it is
+// cheaper than the equivalent scalar instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace llvm;
+
+static cl::list<std::string>
+Opcodes("opcodes", cl::CommaSeparated,
+        cl::desc("Opcodes to measure (default: all integer and floating "
+                 "point binary operators)"));
+
+static cl::list<std::string>
+Types("types", cl::CommaSeparated,
+      cl::desc("Element types to measure (default: i8,i16,i32,i64,float,"
+               "double)"));
+
+static cl::opt<unsigned>
+MaxVF("max-vf", cl::init(16), cl::desc("Largest vector width to measure"));
+
+static cl::opt<std::string>
+MCPU("mcpu", cl::desc("CPU to generate code for (default: the host CPU)"),
+     cl::value_desc("cpu-name"), cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr", cl::CommaSeparated,
+       cl::desc("Target specific attributes (default: the host features)"),
+       cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned>
+NumChains("chains", cl::init(8),
+          cl::desc("Number of independent accumulators in a kernel"));
+
+static cl::opt<unsigned>
+UnrollCount("unroll", cl::init(4),
+            cl::desc("Number of times each accumulator is updated per loop "
+                     "iteration"));
+
+static cl::opt<unsigned>
+NumIterations("iterations", cl::init(10000),
+              cl::desc("Number of loop iterations in one measurement"));
+
+static cl::opt<unsigned>
+NumRepeats("repeat", cl::init(5),
+           cl::desc("Number of measurements; the fastest one is reported"));
+
+static cl::opt<double>
+Tolerance("tolerance", cl::init(2.0),
+          cl::desc("Flag kernels whose measured throughput differs from the "
+                   "scaled cost by more than this factor"));
+
+static cl::opt<bool>
+OnlyDisagreements("only-disagreements", cl::init(false),
+                  cl::desc("Only print the kernels that are flagged"));
+
+namespace {
+/// One measured kernel.
+struct Measurement {
+  unsigned Opcode;
+  Type *ElemTy;
+  unsigned VF;
+  unsigned Cost;     // TTI arithmetic instruction cost.
+  double Measured;   // Cycles (or nanoseconds) per instruction.
+};
+} // end anonymous namespace
+
+static unsigned parseOpcode(StringRef Name) {
+  return StringSwitch<unsigned>(Name)
+      .Case("add", Instruction::Add)
+      .Case("sub", Instruction::Sub)
+      .Case("mul", Instruction::Mul)
+      .Case("udiv", Instruction::UDiv)
+      .Case("sdiv", Instruction::SDiv)
+      .Case("urem", Instruction::URem)
+      .Case("srem", Instruction::SRem)
+      .Case("shl", Instruction::Shl)
+      .Case("lshr", Instruction::LShr)
+      .Case("ashr", Instruction::AShr)
+      .Case("and", Instruction::And)
+      .Case("or", Instruction::Or)
+      .Case("xor", Instruction::Xor)
+      .Case("fadd", Instruction::FAdd)
+      .Case("fsub", Instruction::FSub)
+      .Case("fmul", Instruction::FMul)
+      .Case("fdiv", Instruction::FDiv)
+      .Default(0);
+}
+
+static Type *parseType(StringRef Name, LLVMContext &Ctx) {
+  return StringSwitch<Type *>(Name)
+      .Case("i8", Type::getInt8Ty(Ctx))
+      .Case("i16", Type::getInt16Ty(Ctx))
+      .Case("i32", Type::getInt32Ty(Ctx))
+      .Case("i64", Type::getInt64Ty(Ctx))
+      .Case("float", Type::getFloatTy(Ctx))
+      .Case("double", Type::getDoubleTy(Ctx))
+      .Default(nullptr);
+}
+
+static bool isFPOpcode(unsigned Opcode) {
+  return Opcode == Instruction::FAdd || Opcode == Instruction::FSub ||
+         Opcode == Instruction::FMul || Opcode == Instruction::FDiv;
+}
+
+/// Build the kernel
+///
+///   i64 @Name(<Ty>* %state, i64 %n)
+///
+/// which loads NumChains accumulators and the operand from \p state, applies
+/// the operator NumChains * UnrollCount times per iteration for \p n
+/// iterations, and stores the accumulators back. If \p UseCycleCounter is
+/// set, it returns the number of cycles the loop took.
+static Function *buildKernel(Module &M, StringRef Name, unsigned Opcode,
+                             Type *Ty, bool UseCycleCounter) {
+  LLVMContext &Ctx = M.getContext();
+  Type *Int64Ty = Type::getInt64Ty(Ctx);
+  FunctionType *FTy =
+      FunctionType::get(Int64Ty, {Ty->getPointerTo(), Int64Ty}, false);
+  Function *F =
+      Function::Create(FTy, GlobalValue::ExternalLinkage, Name, &M);
+  Function::arg_iterator AI = F->arg_begin();
+  Value *State = AI++;
+  Value *N = AI;
+
+  BasicBlock *Entry = BasicBlock::Create(Ctx, "entry", F);
+  BasicBlock *Loop = BasicBlock::Create(Ctx, "loop", F);
+  BasicBlock *Exit = BasicBlock::Create(Ctx, "exit", F);
+  IRBuilder<> B(Entry);
+  Function *ReadCycles =
+      Intrinsic::getDeclaration(&M, Intrinsic::readcyclecounter);
+
+  // The state is only guaranteed to be element aligned. It is accessed
+  // outside the loop, so this does not affect the measurement.
+  unsigned Align = Ty->getScalarSizeInBits() / 8;
+  SmallVector<Value *, 16> Init;
+  for (unsigned i = 0; i != NumChains; ++i)
+    Init.push_back(
+        B.CreateAlignedLoad(B.CreateConstGEP1_32(Ty, State, i), Align));
+  Value *Operand =
+      B.CreateAlignedLoad(B.CreateConstGEP1_32(Ty, State, NumChains), Align);
+  Value *Start = UseCycleCounter ? B.CreateCall(ReadCycles, {}) : nullptr;
+  B.CreateBr(Loop);
+
+  B.SetInsertPoint(Loop);
+  PHINode *IV = B.CreatePHI(Int64Ty, 2, "iv");
+  IV->addIncoming(B.getInt64(0), Entry);
+  SmallVector<PHINode *, 16> Accs;
+  SmallVector<Value *, 16> Cur;
+  for (unsigned i = 0; i != NumChains; ++i) {
+    PHINode *Acc = B.CreatePHI(Ty, 2, "acc");
+    Acc->addIncoming(Init[i], Entry);
+    Accs.push_back(Acc);
+    Cur.push_back(Acc);
+  }
+  for (unsigned u = 0; u != UnrollCount; ++u)
+    for (unsigned i = 0; i != NumChains; ++i)
+      Cur[i] = B.CreateBinOp(Instruction::BinaryOps(Opcode), Cur[i], Operand);
+  for (unsigned i = 0; i != NumChains; ++i)
+    Accs[i]->addIncoming(Cur[i], Loop);
+  Value *Next = B.CreateAdd(IV, B.getInt64(1));
+  IV->addIncoming(Next, Loop);
+  B.CreateCondBr(B.CreateICmpULT(Next, N), Loop, Exit);
+
+  B.SetInsertPoint(Exit);
+  Value *Cycles = B.getInt64(0);
+  if (UseCycleCounter)
+    Cycles = B.CreateSub(B.CreateCall(ReadCycles, {}), Start);
+  for (unsigned i = 0; i != NumChains; ++i)
+    B.CreateAlignedStore(Cur[i], B.CreateConstGEP1_32(Ty, State, i), Align);
+  B.CreateRet(Cycles);
+  return F;
+}
+
+/// Fill \p Buffer with NumChains + 1 vectors of \p Bytes bytes whose elements
+/// of type \p Ty are all one. One keeps every operator well defined and away
+/// from denormals.
+static void initState(std::vector<uint64_t> &Buffer, Type *Ty,
+                      unsigned Bytes) {
+  unsigned Total = Bytes * (NumChains + 1);
+  Buffer.assign((Total + 7) / 8, 0);
+  char *P = reinterpret_cast<char *>(Buffer.data());
+  unsigned ElemBytes = Ty->getScalarSizeInBits() / 8;
+  for (unsigned Off = 0; Off < Total; Off += ElemBytes) {
+    switch (ElemBytes) {
+    case 1: { uint8_t One = 1;  std::memcpy(P + Off, &One, 1); break; }
+    case 2: { uint16_t One = 1; std::memcpy(P + Off, &One, 2); break; }
+    case 4: {
+      float FOne = 1.0f;
+      uint32_t One = 1;
+      std::memcpy(P + Off, Ty->isFloatTy() ? (void *)&FOne : (void *)&One, 4);
+      break;
+    }
+    case 8: {
+      double FOne = 1.0;
+      uint64_t One = 1;
+      std::memcpy(P + Off, Ty->isDoubleTy() ? (void *)&FOne : (void *)&One, 8);
+      break;
+    }
+    }
+  }
+}
+
+static std::string getTypeName(Type *Ty) {
+  std::string S;
+  raw_string_ostream OS(S);
+  Ty->print(OS);
+  return OS.str();
+}
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  LLVMContext &Context = getGlobalContext();
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+
+  cl::ParseCommandLineOptions(argc, argv,
+                              "llvm cost model validation benchmark\n");
+
+  SmallVector<unsigned, 16> OpcodeList;
+  if (Opcodes.empty())
+    for (StringRef Name : {"add", "sub", "mul", "udiv", "sdiv", "urem", "srem",
+                           "shl", "lshr", "ashr", "and", "or", "xor", "fadd",
+                           "fsub", "fmul", "fdiv"})
+      Opcodes.push_back(Name);
+  for (const std::string &Name : Opcodes) {
+    unsigned Opcode = parseOpcode(Name);
+    if (!Opcode) {
+      errs() << argv[0] << ": unknown opcode '" << Name << "'\n";
+      return 1;
+    }
+    OpcodeList.push_back(Opcode);
+  }
+
+  SmallVector<Type *, 8> TypeList;
+  if (Types.empty())
+    for (StringRef Name : {"i8", "i16", "i32", "i64", "float", "double"})
+      Types.push_back(Name);
+  for (const std::string &Name : Types) {
+    Type *Ty = parseType(Name, Context);
+    if (!Ty) {
+      errs() << argv[0] << ": unknown type '" << Name << "'\n";
+      return 1;
+    }
+    TypeList.push_back(Ty);
+  }
+
+  // Compile for the host, with all of its features unless told otherwise.
+  std::string CPU = MCPU.empty() ? sys::getHostCPUName().str() : MCPU;
+  std::vector<std::string> Attrs(MAttrs.begin(), MAttrs.end());
+  StringMap<bool> HostFeatures;
+  if (Attrs.empty() && MCPU.empty() && sys::getHostCPUFeatures(HostFeatures))
+    for (auto &Feature : HostFeatures)
+      Attrs.push_back((Feature.second ? "+" : "-") + Feature.first().str());
+
+  Triple HostTriple(sys::getProcessTriple());
+  bool UseCycleCounter = HostTriple.getArch() == Triple::x86 ||
+                         HostTriple.getArch() == Triple::x86_64;
+
+  std::unique_ptr<Module> Owner = make_unique<Module>("cost-bench", Context);
+  Owner->setTargetTriple(HostTriple.str());
+  std::string ErrorMsg;
+  EngineBuilder Builder(std::move(Owner));
+  Builder.setEngineKind(EngineKind::JIT)
+      .setErrorStr(&ErrorMsg)
+      .setOptLevel(CodeGenOpt::Aggressive)
+      .setMCPU(CPU)
+      .setMAttrs(Attrs)
+      .setMCJITMemoryManager(make_unique<SectionMemoryManager>());
+  TargetMachine *TM = Builder.selectTarget();
+  if (!TM) {
+    errs() << argv[0] << ": " << ErrorMsg << "\n";
+    return 1;
+  }
+  std::unique_ptr<ExecutionEngine> EE(Builder.create(TM));
+  if (!EE) {
+    errs() << argv[0] << ": " << ErrorMsg << "\n";
+    return 1;
+  }
+  TargetIRAnalysis TIRA = TM->getTargetIRAnalysis();
+
+  typedef uint64_t (*KernelFn)(void *, uint64_t);
+  std::vector<Measurement> Results;
+  std::vector<uint64_t> State;
+  unsigned KernelNo = 0;
+  for (unsigned Opcode : OpcodeList) {
+    for (Type *ElemTy : TypeList) {
+      if (isFPOpcode(Opcode) != ElemTy->isFloatingPointTy())
+        continue;
+      for (unsigned VF = 1; VF <= MaxVF; VF *= 2) {
+        Type *Ty = VF == 1 ? ElemTy : VectorType::get(ElemTy, VF);
+        std::string Name = "kernel" + utostr(KernelNo++);
+        std::unique_ptr<Module> M = make_unique<Module>(Name, Context);
+        M->setTargetTriple(HostTriple.str());
+        M->setDataLayout(*TM->getDataLayout());
+        Function *F = buildKernel(*M, Name, Opcode, Ty, UseCycleCounter);
+
+        Measurement R;
+        R.Opcode = Opcode;
+        R.ElemTy = ElemTy;
+        R.VF = VF;
+        R.Cost = TIRA.run(*F).getArithmeticInstrCost(Opcode, Ty);
+
+        EE->addModule(std::move(M));
+        KernelFn Kernel = reinterpret_cast<KernelFn>(
+            static_cast<uintptr_t>(EE->getFunctionAddress(Name)));
+        EE->finalizeObject();
+        if (!Kernel) {
+          errs() << argv[0] << ": failed to compile " << Name << "\n";
+          return 1;
+        }
+
+        unsigned Bytes = Ty->getPrimitiveSizeInBits() / 8;
+        initState(State, ElemTy, Bytes);
+        Kernel(State.data(), std::max(1u, NumIterations / 10));
+        double Best = 0;
+        for (unsigned Rep = 0; Rep != NumRepeats; ++Rep) {
+          initState(State, ElemTy, Bytes);
+          auto Begin = std::chrono::steady_clock::now();
+          uint64_t Cycles = Kernel(State.data(), NumIterations);
+          auto End = std::chrono::steady_clock::now();
+          double Time = UseCycleCounter
+                            ? double(Cycles)
+                            : std::chrono::duration<double, std::nano>(
+                                  End - Begin).count();
+          if (Rep == 0 || Time < Best)
+            Best = Time;
+        }
+        R.Measured =
+            Best / (double(NumIterations) * NumChains * UnrollCount);
+        Results.push_back(R);
+      }
+    }
+  }
+
+  if (Results.empty()) {
+    errs() << argv[0] << ": no kernels to measure\n";
+    return 1;
+  }
+
+  // Cycles per unit of cost, as the median over all kernels.
+  std::vector<double> Ratios;
+  for (const Measurement &R : Results)
+    if (R.Cost)
+      Ratios.push_back(R.Measured / R.Cost);
+  std::sort(Ratios.begin(), Ratios.end());
+  double Scale = Ratios.empty() ? 1.0 : Ratios[Ratios.size() / 2];
+  const char *Unit = UseCycleCounter ? "cycles" : "ns";
+
+  outs() << "; host: " << HostTriple.str() << ", cpu: " << CPU << "\n"
+         << "; one unit of cost is " << format("%.3f", Scale) << " " << Unit
+         << "\n";
+  outs() << "opcode type               cost " << format("%10s", Unit)
+         << "    error  flags\n";
+
+  unsigned NumOff = 0, NumVFMismatch = 0;
+  for (unsigned i = 0, e = Results.size(); i != e; ++i) {
+    const Measurement &R = Results[i];
+    double Error = R.Cost ? R.Measured / (R.Cost * Scale) : 0.0;
+    bool Off = R.Cost && (Error > Tolerance || Error * Tolerance < 1.0);
+
+    // Compare against the scalar kernel of the same opcode and type, which
+    // is always measured first.
+    bool VFMismatch = false;
+    if (R.VF > 1) {
+      const Measurement *Scalar = nullptr;
+      for (unsigned j = i; j-- != 0;)
+        if (Results[j].Opcode == R.Opcode && Results[j].ElemTy == R.ElemTy &&
+            Results[j].VF == 1) {
+          Scalar = &Results[j];
+          break;
+        }
+      if (Scalar) {
+        bool ModelSaysVector = R.Cost < R.VF * Scalar->Cost;
+        bool HostSaysVector = R.Measured < R.VF * Scalar->Measured;
+        VFMismatch = ModelSaysVector != HostSaysVector;
+      }
+    }
+    NumOff += Off;
+    NumVFMismatch += VFMismatch;
+    if (OnlyDisagreements && !Off && !VFMismatch)
+      continue;
+
+    Type *Ty = R.VF == 1 ? R.ElemTy : VectorType::get(R.ElemTy, R.VF);
+    std::string Flags;
+    if (Off)
+      Flags += Error > 1.0 ? "underestimated " : "overestimated ";
+    if (VFMismatch)
+      Flags += "vectorization";
+    outs() << format("%-6s %-16s %6u %10.3f %8.2f  %s\n",
+                     Instruction::getOpcodeName(R.Opcode),
+                     getTypeName(Ty).c_str(), R.Cost, R.Measured, Error,
+                     Flags.c_str());
+  }
+
+  outs() << "; " << Results.size() << " kernels, " << NumOff
+         << " off by more than " << format("%.1f", double(Tolerance))
+         << "x, " << NumVFMismatch
+         << " disagree on vector profitability\n";
+  return 0;
+}
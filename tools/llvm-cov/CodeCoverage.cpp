@@ -20,6 +20,7 @@
 #include "SourceCoverageView.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/InstrProfReader.h"
@@ -27,6 +28,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Process.h"
@@ -54,6 +56,9 @@ public:
   /// \brief Return a memory buffer for the given source file.
   ErrorOr<const MemoryBuffer &> getSourceFile(StringRef SourceFile);
 
+  /// \brief Read the given source files ahead of their use, concurrently.
+  void prefetchSourceFiles(ArrayRef<std::string> Files);
+
   /// \brief Create source views for the expansions of the view.
   void attachExpansionSubViews(SourceCoverageView &View,
                                ArrayRef<ExpansionRecord> Expansions,
@@ -108,6 +113,9 @@ CodeCoverageTool::getSourceFile(StringRef SourceFile) {
     if (Loc != RemappedFilenames.end())
       SourceFile = Loc->second;
   }
+  for (const auto &Files : LoadedSourceFiles)
+    if (SourceFile == Files.first)
+      return *Files.second;
   for (const auto &Files : LoadedSourceFiles)
     if (sys::fs::equivalent(SourceFile, Files.first))
       return *Files.second;
@@ -120,6 +128,31 @@ CodeCoverageTool::getSourceFile(StringRef SourceFile) {
   return *LoadedSourceFiles.back().second;
 }
 
+void CodeCoverageTool::prefetchSourceFiles(ArrayRef<std::string> Files) {
+  StringSet<> Loaded;
+  for (const auto &File : LoadedSourceFiles)
+    Loaded.insert(File.first);
+
+  std::vector<std::string> Paths;
+  for (StringRef File : Files) {
+    auto Loc = RemappedFilenames.find(File);
+    if (Loc != RemappedFilenames.end())
+      File = Loc->second;
+    // "-" is not stdin here, leave it to getSourceFile.
+    if (File != "-" && Loaded.insert(File).second)
+      Paths.push_back(File);
+  }
+
+  // Files that can't be read are left for getSourceFile to report when they
+  // are actually needed.
+  MemoryBuffer::getFilesOrSTDIN(
+      Paths,
+      [&](size_t Index, ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer) {
+    if (Buffer)
+      LoadedSourceFiles.emplace_back(Paths[Index], std::move(Buffer.get()));
+  });
+}
+
 void
 CodeCoverageTool::attachExpansionSubViews(SourceCoverageView &View,
                                           ArrayRef<ExpansionRecord> Expansions,
@@ -452,6 +485,8 @@ int CodeCoverageTool::show(int argc, const char **argv,
     for (StringRef Filename : Coverage->getUniqueSourceFiles())
       SourceFiles.push_back(Filename);
 
+  prefetchSourceFiles(SourceFiles);
+
   for (const auto &SourceFile : SourceFiles) {
     auto mainView = createSourceFileView(SourceFile, *Coverage);
     if (!mainView) {
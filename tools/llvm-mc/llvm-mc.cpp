@@ -425,6 +425,9 @@ int main(int argc, char **argv) {
       return 1;
     }
     MAI->setCompressDebugSections(true);
+    MAI->setCompressDebugSectionsFast(MCOptions.CompressDebugSectionsFast);
+    MAI->setCompressDebugSectionsThreads(
+        MCOptions.CompressDebugSectionsThreads);
   }
 
   // FIXME: This is not pretty. MCContext has a ptr to MCObjectFileInfo and
@@ -0,0 +1,534 @@
+//===-- llvm-mca.cpp - Machine Code Analyzer ------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility statically estimates the steady-state throughput of a block of
+// machine code, typically the body of a hot loop.
+//
+// The assembly is parsed with the target's MCAsmParser. The instructions are
+// then run through a simple model of an out-of-order core: they dispatch in
+// order up to the issue width, execute once their register operands are ready
+// and a unit of every processor resource they use is free, and retire in
+// order. The latencies, micro-op counts and resource usage come from the
+// subtarget's MCSchedModel, i.e. from the same .td scheduling models that
+// drive the MachineScheduler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSchedule.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetAsmParser.h"
+#include "llvm/MC/MCTargetOptionsCommandFlags.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
+using namespace llvm;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<input file>"), cl::init("-"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
+               cl::init("-"));
+
+static cl::opt<std::string>
+TripleName("triple", cl::desc("Target triple to analyze for"));
+
+static cl::alias
+TripleNameA("mtriple", cl::desc("Alias for -triple"),
+            cl::aliasopt(TripleName));
+
+static cl::opt<std::string>
+ArchName("arch", cl::desc("Target arch to analyze for, "
+                          "see -version for available targets"));
+
+static cl::opt<std::string>
+MCPU("mcpu", cl::desc("Target a specific cpu type (-mcpu=help for details)"),
+     cl::value_desc("cpu-name"), cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr", cl::CommaSeparated,
+       cl::desc("Target specific attributes (-mattr=help for details)"),
+       cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned>
+Iterations("iterations", cl::desc("Number of times the block is executed"),
+           cl::init(100));
+
+static cl::opt<unsigned>
+DispatchWidth("dispatch", cl::desc("Override the issue width of the "
+                                   "scheduling model (0 = use the model)"),
+              cl::init(0));
+
+static cl::opt<bool>
+PrintInstrInfo("instruction-info",
+               cl::desc("Print the scheduling information of each "
+                        "instruction"),
+               cl::init(true));
+
+namespace {
+
+/// Streamer that records the parsed instructions and drops everything else.
+class MCInstCollector : public MCStreamer {
+  std::vector<MCInst> &Insts;
+
+public:
+  MCInstCollector(MCContext &Context, std::vector<MCInst> &Insts)
+      : MCStreamer(Context), Insts(Insts) {}
+
+  void EmitInstruction(const MCInst &Inst,
+                       const MCSubtargetInfo &STI) override {
+    Insts.push_back(Inst);
+  }
+
+  bool EmitSymbolAttribute(MCSymbol *Symbol,
+                           MCSymbolAttr Attribute) override {
+    return true;
+  }
+  void EmitCommonSymbol(MCSymbol *Symbol, uint64_t Size,
+                        unsigned ByteAlignment) override {}
+  void EmitZerofill(MCSection *Section, MCSymbol *Symbol = nullptr,
+                    uint64_t Size = 0, unsigned ByteAlignment = 0) override {}
+  void EmitGPRel32Value(const MCExpr *Value) override {}
+};
+
+/// Scheduling information of one instruction of the analyzed block.
+struct InstrSchedInfo {
+  /// False if the scheduling model has no usable class for the instruction,
+  /// either because it is missing or because it is a variant that can only be
+  /// resolved on a MachineInstr.
+  bool Known;
+  unsigned NumMicroOps;
+  unsigned Latency;
+  /// (ProcResourceIdx, Cycles) pairs.
+  SmallVector<std::pair<unsigned, unsigned>, 4> Resources;
+  SmallVector<unsigned, 4> Defs;
+  SmallVector<unsigned, 4> Uses;
+};
+
+/// Model of an out-of-order core driven by an MCSchedModel.
+///
+/// Instructions dispatch in program order, at most IssueWidth micro-ops per
+/// cycle, as long as the micro-op buffer (the reorder buffer) has room. An
+/// instruction starts executing once its source registers are ready and every
+/// processor resource it uses has a free unit; it holds the unit for the
+/// number of cycles given by the model. Instructions retire in order, at most
+/// IssueWidth per cycle. Memory dependencies and read-advance (forwarding)
+/// entries are not modeled.
+class ThroughputSimulator {
+  const MCSchedModel &SM;
+  const MCRegisterInfo &MRI;
+  unsigned Width;
+
+  /// Cycle at which each unit of each processor resource becomes free.
+  std::vector<SmallVector<uint64_t, 4>> UnitFree;
+  /// Cycle at which each physical register's value becomes available.
+  std::vector<uint64_t> RegReady;
+  /// In-flight instructions as (retire cycle, micro-ops).
+  std::deque<std::pair<uint64_t, unsigned>> InFlight;
+  unsigned InFlightMicroOps;
+
+  uint64_t DispatchCycle;
+  unsigned DispatchSlotsUsed;
+  uint64_t RetireCycle;
+  unsigned RetireSlotsUsed;
+  uint64_t LastStart;
+
+public:
+  /// Cycles consumed on each processor resource.
+  std::vector<uint64_t> ResourceCycles;
+  uint64_t NumInstrs;
+  uint64_t NumMicroOps;
+
+  ThroughputSimulator(const MCSchedModel &SM, const MCRegisterInfo &MRI,
+                      unsigned Width)
+      : SM(SM), MRI(MRI), Width(Width), UnitFree(SM.getNumProcResourceKinds()),
+        RegReady(MRI.getNumRegs(), 0), InFlightMicroOps(0), DispatchCycle(0),
+        DispatchSlotsUsed(0), RetireCycle(0), RetireSlotsUsed(0),
+        LastStart(0), ResourceCycles(SM.getNumProcResourceKinds(), 0),
+        NumInstrs(0), NumMicroOps(0) {
+    for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I != E; ++I)
+      UnitFree[I].assign(std::max(1u, SM.getProcResource(I)->NumUnits), 0);
+  }
+
+  void run(const InstrSchedInfo &Info);
+
+  /// Total number of cycles until the last instruction retired.
+  uint64_t getTotalCycles() const { return NumInstrs ? RetireCycle + 1 : 0; }
+};
+
+} // end anonymous namespace
+
+void ThroughputSimulator::run(const InstrSchedInfo &Info) {
+  ++NumInstrs;
+  NumMicroOps += Info.NumMicroOps;
+
+  // Dispatch. Wait for room in the micro-op buffer first.
+  unsigned BufferSize = SM.MicroOpBufferSize;
+  while (!InFlight.empty() && InFlight.front().first <= DispatchCycle) {
+    InFlightMicroOps -= InFlight.front().second;
+    InFlight.pop_front();
+  }
+  while (BufferSize > 1 && !InFlight.empty() &&
+         InFlightMicroOps + Info.NumMicroOps > BufferSize) {
+    if (InFlight.front().first > DispatchCycle) {
+      DispatchCycle = InFlight.front().first;
+      DispatchSlotsUsed = 0;
+    }
+    InFlightMicroOps -= InFlight.front().second;
+    InFlight.pop_front();
+  }
+  for (unsigned Remaining = Info.NumMicroOps; Remaining;) {
+    if (DispatchSlotsUsed == Width) {
+      ++DispatchCycle;
+      DispatchSlotsUsed = 0;
+    }
+    unsigned N = std::min(Remaining, Width - DispatchSlotsUsed);
+    DispatchSlotsUsed += N;
+    Remaining -= N;
+  }
+
+  // Execute once the operands are ready and a unit of each resource is free.
+  uint64_t Start = DispatchCycle;
+  for (unsigned Reg : Info.Uses)
+    Start = std::max(Start, RegReady[Reg]);
+  // Without a micro-op buffer the core is in order.
+  if (BufferSize <= 1)
+    Start = std::max(Start, LastStart);
+  for (const auto &Res : Info.Resources) {
+    const SmallVectorImpl<uint64_t> &Units = UnitFree[Res.first];
+    Start = std::max(Start, *std::min_element(Units.begin(), Units.end()));
+  }
+  for (const auto &Res : Info.Resources) {
+    ResourceCycles[Res.first] += Res.second;
+    if (!Res.second)
+      continue;
+    SmallVectorImpl<uint64_t> &Units = UnitFree[Res.first];
+    uint64_t &Unit = *std::min_element(Units.begin(), Units.end());
+    Unit = Start + Res.second;
+  }
+  LastStart = Start;
+
+  uint64_t Complete = Start + std::max(1u, Info.Latency);
+  for (unsigned Reg : Info.Defs)
+    for (MCRegAliasIterator AI(Reg, &MRI, true); AI.isValid(); ++AI)
+      RegReady[*AI] = Complete;
+
+  // Retire in order.
+  if (Complete > RetireCycle) {
+    RetireCycle = Complete;
+    RetireSlotsUsed = 0;
+  }
+  if (RetireSlotsUsed == Width) {
+    ++RetireCycle;
+    RetireSlotsUsed = 0;
+  }
+  ++RetireSlotsUsed;
+
+  InFlight.push_back(std::make_pair(RetireCycle, Info.NumMicroOps));
+  InFlightMicroOps += Info.NumMicroOps;
+}
+
+static InstrSchedInfo getSchedInfo(const MCInst &Inst,
+                                   const MCInstrInfo &MCII,
+                                   const MCSubtargetInfo &STI) {
+  const MCSchedModel &SM = STI.getSchedModel();
+  const MCInstrDesc &MCID = MCII.get(Inst.getOpcode());
+  InstrSchedInfo Info;
+
+  // Collect the physical registers written and read.
+  for (unsigned I = 0, E = Inst.getNumOperands(); I != E; ++I) {
+    const MCOperand &MO = Inst.getOperand(I);
+    if (!MO.isReg() || !MO.getReg())
+      continue;
+    if (I < MCID.getNumDefs())
+      Info.Defs.push_back(MO.getReg());
+    else
+      Info.Uses.push_back(MO.getReg());
+  }
+  for (unsigned I = 0, E = MCID.getNumImplicitDefs(); I != E; ++I)
+    Info.Defs.push_back(MCID.getImplicitDefs()[I]);
+  for (unsigned I = 0, E = MCID.getNumImplicitUses(); I != E; ++I)
+    Info.Uses.push_back(MCID.getImplicitUses()[I]);
+
+  const MCSchedClassDesc *SC = SM.getSchedClassDesc(MCID.getSchedClass());
+  Info.Known = SC->isValid() && !SC->isVariant();
+  if (!Info.Known) {
+    Info.NumMicroOps = 1;
+    Info.Latency = 1;
+    return Info;
+  }
+
+  Info.NumMicroOps = SC->NumMicroOps;
+  Info.Latency = 0;
+  for (unsigned I = 0, E = SC->NumWriteLatencyEntries; I != E; ++I) {
+    int Cycles = STI.getWriteLatencyEntry(SC, I)->Cycles;
+    if (Cycles > 0)
+      Info.Latency = std::max(Info.Latency, unsigned(Cycles));
+  }
+  for (const MCWriteProcResEntry *PRE = STI.getWriteProcResBegin(SC),
+                                 *PRE_End = STI.getWriteProcResEnd(SC);
+       PRE != PRE_End; ++PRE)
+    Info.Resources.push_back(
+        std::make_pair(PRE->ProcResourceIdx, PRE->Cycles));
+  return Info;
+}
+
+static void printResourceName(raw_ostream &OS, const MCSchedModel &SM,
+                              unsigned Idx) {
+#ifndef NDEBUG
+  OS << SM.getProcResource(Idx)->Name;
+#else
+  // Resource names are only kept in the tables of builds with assertions.
+  (void)SM;
+  OS << "ProcRes" << Idx;
+#endif
+}
+
+static void printInstruction(raw_ostream &OS, MCInstPrinter &IP,
+                             const MCInst &Inst, const MCSubtargetInfo &STI) {
+  std::string Str;
+  raw_string_ostream SS(Str);
+  IP.printInst(&Inst, SS, "", STI);
+  OS << StringRef(SS.str()).trim();
+}
+
+static void printReport(raw_ostream &OS, const std::vector<MCInst> &Insts,
+                        const std::vector<InstrSchedInfo> &Infos,
+                        const ThroughputSimulator &Sim, unsigned Width,
+                        const MCSubtargetInfo &STI, MCInstPrinter &IP) {
+  const MCSchedModel &SM = STI.getSchedModel();
+  uint64_t Cycles = Sim.getTotalCycles();
+  double CyclesPerIter = double(Cycles) / Iterations;
+
+  // Lower bounds on the cycles per iteration.
+  unsigned MicroOpsPerIter = 0;
+  for (const InstrSchedInfo &Info : Infos)
+    MicroOpsPerIter += Info.NumMicroOps;
+  double DispatchBound = double(MicroOpsPerIter) / Width;
+  double ResourceBound = 0;
+  unsigned BottleneckIdx = 0;
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I != E; ++I) {
+    double Pressure = double(Sim.ResourceCycles[I]) / Iterations /
+                      std::max(1u, SM.getProcResource(I)->NumUnits);
+    if (Pressure > ResourceBound) {
+      ResourceBound = Pressure;
+      BottleneckIdx = I;
+    }
+  }
+  double RThroughput = std::max(DispatchBound, ResourceBound);
+
+  OS << "Iterations:        " << Iterations << '\n'
+     << "Instructions:      " << Sim.NumInstrs << '\n'
+     << "Total Cycles:      " << Cycles << '\n'
+     << "Total uOps:        " << Sim.NumMicroOps << "\n\n"
+     << "Dispatch Width:    " << Width << '\n'
+     << "uOps Per Cycle:    "
+     << format("%.2f", Cycles ? double(Sim.NumMicroOps) / Cycles : 0.0) << '\n'
+     << "IPC:               "
+     << format("%.2f", Cycles ? double(Sim.NumInstrs) / Cycles : 0.0) << '\n'
+     << "Cycles Per Iter:   " << format("%.2f", CyclesPerIter) << '\n'
+     << "Block RThroughput: " << format("%.2f", RThroughput) << "\n\n";
+
+  // A simulated loop running well above its throughput bound is held back by
+  // a dependency chain.
+  OS << "Bottleneck:        ";
+  if (CyclesPerIter > RThroughput * 1.1 + 0.5)
+    OS << "dependency chain (latency bound)\n";
+  else if (BottleneckIdx && ResourceBound >= DispatchBound) {
+    OS << "resource pressure on ";
+    printResourceName(OS, SM, BottleneckIdx);
+    OS << '\n';
+  } else
+    OS << "dispatch width\n";
+
+  OS << "\nResource pressure per iteration:\n";
+  for (unsigned I = 1, E = SM.getNumProcResourceKinds(); I != E; ++I) {
+    if (!Sim.ResourceCycles[I])
+      continue;
+    std::string Name;
+    raw_string_ostream NS(Name);
+    printResourceName(NS, SM, I);
+    OS << "  " << left_justify(NS.str(), 16) << " units "
+       << SM.getProcResource(I)->NumUnits << "  cycles "
+       << format("%.2f", double(Sim.ResourceCycles[I]) / Iterations) << '\n';
+  }
+
+  if (!PrintInstrInfo)
+    return;
+  OS << "\nInstruction Info:\n"
+     << "[1]: #uOps\n[2]: Latency\n\n"
+     << "[1]    [2]    Instructions:\n";
+  for (unsigned I = 0, E = Insts.size(); I != E; ++I) {
+    const InstrSchedInfo &Info = Infos[I];
+    OS << ' ' << left_justify(Info.Known ? utostr(Info.NumMicroOps) : "?", 7)
+       << left_justify(Info.Known ? utostr(Info.Latency) : "?", 7);
+    printInstruction(OS, IP, Insts[I], STI);
+    OS << '\n';
+  }
+}
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  // Initialize targets and assembly parsers.
+  llvm::InitializeAllTargetInfos();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmParsers();
+
+  // Register the target printer for --version.
+  cl::AddExtraVersionPrinter(TargetRegistry::printRegisteredTargetsForVersion);
+
+  cl::ParseCommandLineOptions(argc, argv, "llvm machine code analyzer\n");
+  MCTargetOptions MCOptions = InitMCTargetOptionsFromFlags();
+  const char *ProgName = argv[0];
+
+  if (!Iterations) {
+    errs() << ProgName << ": error: -iterations must be at least 1\n";
+    return 1;
+  }
+
+  if (TripleName.empty())
+    TripleName = sys::getDefaultTargetTriple();
+  Triple TheTriple(Triple::normalize(TripleName));
+  std::string Error;
+  const Target *TheTarget =
+      TargetRegistry::lookupTarget(ArchName, TheTriple, Error);
+  if (!TheTarget) {
+    errs() << ProgName << ": " << Error;
+    return 1;
+  }
+  TripleName = TheTriple.getTriple();
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (std::error_code EC = BufferPtr.getError()) {
+    errs() << ProgName << ": " << InputFilename << ": " << EC.message()
+           << '\n';
+    return 1;
+  }
+
+  SourceMgr SrcMgr;
+  SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  assert(MRI && "Unable to create target register info!");
+
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  assert(MAI && "Unable to create target asm info!");
+
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+  MOFI.InitMCObjectFileInfo(TheTriple, Reloc::Default, CodeModel::Default,
+                            Ctx);
+
+  std::string FeaturesStr;
+  if (MAttrs.size()) {
+    SubtargetFeatures Features;
+    for (unsigned i = 0; i != MAttrs.size(); ++i)
+      Features.AddFeature(MAttrs[i]);
+    FeaturesStr = Features.getString();
+  }
+
+  if (MCPU.empty())
+    MCPU = sys::getHostCPUName();
+
+  std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TripleName, MCPU, FeaturesStr));
+  const MCSchedModel &SM = STI->getSchedModel();
+  if (!SM.hasInstrSchedModel()) {
+    errs() << ProgName << ": error: no instruction scheduling model for cpu '"
+           << MCPU << "'\n";
+    return 1;
+  }
+
+  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+      TheTriple, MAI->getAssemblerDialect(), *MAI, *MCII, *MRI));
+  if (!IP) {
+    errs() << ProgName << ": error: unable to create instruction printer for "
+           << "target triple '" << TripleName << "'\n";
+    return 1;
+  }
+
+  // Parse the input into a list of instructions.
+  std::vector<MCInst> Insts;
+  MCInstCollector Str(Ctx, Insts);
+  std::unique_ptr<MCAsmParser> Parser(
+      createMCAsmParser(SrcMgr, Ctx, Str, *MAI));
+  std::unique_ptr<MCTargetAsmParser> TAP(
+      TheTarget->createMCAsmParser(*STI, *Parser, *MCII, MCOptions));
+  if (!TAP) {
+    errs() << ProgName
+           << ": error: this target does not support assembly parsing.\n";
+    return 1;
+  }
+  Parser->setTargetParser(*TAP);
+  if (Parser->Run(false))
+    return 1;
+
+  if (Insts.empty()) {
+    errs() << ProgName << ": error: no instructions to analyze\n";
+    return 1;
+  }
+
+  std::vector<InstrSchedInfo> Infos;
+  Infos.reserve(Insts.size());
+  for (const MCInst &Inst : Insts) {
+    Infos.push_back(getSchedInfo(Inst, *MCII, *STI));
+    if (!Infos.back().Known) {
+      errs() << ProgName << ": warning: no scheduling information for '";
+      printInstruction(errs(), *IP, Inst, *STI);
+      errs() << "', assuming a single micro-op with unit latency\n";
+    }
+  }
+
+  unsigned Width = DispatchWidth ? unsigned(DispatchWidth) : SM.IssueWidth;
+  ThroughputSimulator Sim(SM, *MRI, Width);
+  for (unsigned Iter = 0; Iter != Iterations; ++Iter)
+    for (const InstrSchedInfo &Info : Infos)
+      Sim.run(Info);
+
+  std::error_code EC;
+  tool_output_file Out(OutputFilename, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << ProgName << ": " << EC.message() << '\n';
+    return 1;
+  }
+  printReport(Out.os(), Insts, Infos, Sim, Width, *STI, *IP);
+  Out.keep();
+  return 0;
+}
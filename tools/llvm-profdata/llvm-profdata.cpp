@@ -51,20 +51,41 @@ static void mergeInstrProfile(const cl::list<std::string> &Inputs,
   if (EC)
     exitWithError(EC.message(), OutputFilename);
 
+  // The inputs are read concurrently, which matters when there are thousands
+  // of them on a slow file system, but merged in command line order.
   InstrProfWriter Writer;
-  for (const auto &Filename : Inputs) {
-    auto ReaderOrErr = InstrProfReader::create(Filename);
-    if (std::error_code ec = ReaderOrErr.getError())
-      exitWithError(ec.message(), Filename);
+  std::vector<std::string> Filenames(Inputs.begin(), Inputs.end());
+  std::error_code FirstEC;
+  StringRef FirstFailed;
+  MemoryBuffer::getFilesOrSTDIN(
+      Filenames,
+      [&](size_t Index, ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr) {
+    if (FirstEC)
+      return;
+    StringRef Filename = Filenames[Index];
+    if ((FirstEC = BufferOrErr.getError())) {
+      FirstFailed = Filename;
+      return;
+    }
+
+    auto ReaderOrErr = InstrProfReader::create(std::move(BufferOrErr.get()));
+    if ((FirstEC = ReaderOrErr.getError())) {
+      FirstFailed = Filename;
+      return;
+    }
 
     auto Reader = std::move(ReaderOrErr.get());
     for (const auto &I : *Reader)
       if (std::error_code EC =
               Writer.addFunctionCounts(I.Name, I.Hash, I.Counts))
         errs() << Filename << ": " << I.Name << ": " << EC.message() << "\n";
-    if (Reader->hasError())
-      exitWithError(Reader->getError().message(), Filename);
-  }
+    if (Reader->hasError()) {
+      FirstEC = Reader->getError();
+      FirstFailed = Filename;
+    }
+  });
+  if (FirstEC)
+    exitWithError(FirstEC.message(), FirstFailed);
   Writer.write(Output);
 }
 
@@ -0,0 +1,159 @@
+//===-- llvm-startup-bench.cpp - Measure the startup time of a tool -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program measures how long an LLVM tool takes to get going, which is
+// most of the cost of short-lived compiler processes. It runs the tool many
+// times and reports the wall time of:
+//
+//   exec       this program re-executed with nothing to do, which is the cost
+//              of creating a process and loading a binary;
+//   main       the tool with -version, which adds the static constructors,
+//              target registration and command line parsing;
+//   compile    the tool with the given arguments, normally a small input, for
+//              the time to the first compiled output.
+//
+// The difference between the rows is what the tool spends before it gets to
+// the work it was asked to do.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace llvm;
+
+static cl::opt<std::string>
+ToolName(cl::Positional, cl::Required, cl::desc("<tool>"));
+
+static cl::list<std::string>
+ToolArgs(cl::ConsumeAfter, cl::desc("<tool arguments>..."));
+
+static cl::opt<unsigned>
+Runs("runs", cl::init(20),
+     cl::desc("Number of times to run each command (default = 20)"));
+
+// Used when the program runs itself to measure the cost of exec alone.
+static cl::opt<bool>
+ExitImmediately("exit-immediately", cl::Hidden,
+                cl::desc("Exit as soon as the command line is parsed"));
+
+namespace {
+/// \brief The wall times of one command over all the runs, in milliseconds.
+struct Timings {
+  const char *Name;
+  std::vector<double> Millis;
+  bool Failed;
+
+  explicit Timings(const char *Name) : Name(Name), Failed(false) {}
+
+  double min() const { return Millis.front(); }
+  double median() const { return Millis[Millis.size() / 2]; }
+  double max() const { return Millis.back(); }
+};
+}
+
+/// Run Program with Args (not including argv[0]) Runs times with its output
+/// discarded.
+static Timings timeCommand(const char *Name, StringRef Program,
+                           ArrayRef<std::string> Args) {
+  SmallVector<const char *, 16> Argv;
+  Argv.push_back(Program.data());
+  for (const std::string &Arg : Args)
+    Argv.push_back(Arg.c_str());
+  Argv.push_back(nullptr);
+
+  StringRef Empty;
+  const StringRef *Redirects[] = {&Empty, &Empty, &Empty};
+
+  Timings T(Name);
+  for (unsigned I = 0; I != Runs; ++I) {
+    auto Start = std::chrono::steady_clock::now();
+    int Result = sys::ExecuteAndWait(Program, Argv.data(), nullptr, Redirects);
+    auto End = std::chrono::steady_clock::now();
+    if (Result != 0) {
+      T.Failed = true;
+      break;
+    }
+    T.Millis.push_back(
+        std::chrono::duration<double, std::milli>(End - Start).count());
+  }
+  std::sort(T.Millis.begin(), T.Millis.end());
+  return T;
+}
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  cl::ParseCommandLineOptions(argc, argv, "tool startup time benchmark\n");
+  if (ExitImmediately)
+    return 0;
+
+  if (!Runs) {
+    errs() << argv[0] << ": -runs must be at least 1\n";
+    return 1;
+  }
+
+  ErrorOr<std::string> Tool = sys::findProgramByName(ToolName);
+  if (!Tool) {
+    errs() << argv[0] << ": cannot find '" << ToolName << "'\n";
+    return 1;
+  }
+  // This just needs to be some symbol in the binary; C++ doesn't allow taking
+  // the address of ::main.
+  std::string Self =
+      sys::fs::getMainExecutable(argv[0], (void *)(intptr_t)timeCommand);
+
+  std::vector<std::string> SelfArgs = {"-exit-immediately", ToolName};
+  std::vector<std::string> VersionArgs = {"-version"};
+  std::vector<std::string> CompileArgs(ToolArgs.begin(), ToolArgs.end());
+  // Everything after the tool name is passed through, including a "--"
+  // written to separate the tool's options from ours.
+  if (!CompileArgs.empty() && CompileArgs.front() == "--")
+    CompileArgs.erase(CompileArgs.begin());
+
+  std::vector<Timings> Results;
+  Results.push_back(timeCommand("exec", Self, SelfArgs));
+  Results.push_back(timeCommand("main", *Tool, VersionArgs));
+  if (!CompileArgs.empty())
+    Results.push_back(timeCommand("compile", *Tool, CompileArgs));
+
+  outs() << "; " << sys::path::filename(ToolName) << ", " << Runs << " runs, wall time in ms\n";
+  outs() << "; command      min   median      max\n";
+  bool Failed = false;
+  for (const Timings &T : Results) {
+    outs() << T.Name;
+    for (size_t I = strlen(T.Name); I < 8; ++I)
+      outs() << ' ';
+    if (T.Failed) {
+      outs() << "  failed\n";
+      Failed = true;
+      continue;
+    }
+    outs() << format("%9.2f%9.2f%9.2f\n", T.min(), T.median(), T.max());
+  }
+  return Failed ? 1 : 0;
+}
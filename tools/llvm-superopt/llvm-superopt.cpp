@@ -0,0 +1,839 @@
+//===-- llvm-superopt.cpp - Search for missing peephole optimizations -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program harvests short straight-line integer instruction sequences
+// from IR or bitcode files, and searches for cheaper sequences that compute
+// the same value. Run it on code that has already been through the optimizer
+// (e.g. "opt -O2"), and every replacement it finds is a fold that InstCombine
+// and InstructionSimplify are missing.
+//
+// A sequence is a tree of instructions in one basic block with a single
+// output: every instruction but the root has exactly one use, inside the
+// tree. Leaves are constants and free variables. Sequences are canonicalized
+// (variables numbered in order of appearance, constants on the right of
+// commutative operations) and counted across all inputs.
+//
+// For each distinct sequence, replacements are enumerated in order of
+// increasing cost, from a single variable or constant up to trees one
+// instruction shorter than the original. Each candidate is evaluated
+// bit-precisely with APInt against a set of test inputs, and a candidate that
+// survives is checked exhaustively when the inputs are small enough, and
+// against many more random inputs otherwise. Inputs for which the original
+// sequence has undefined behavior are ignored; the replacement must be
+// defined wherever the original is.
+//
+// The report lists sequences with a replacement, most frequent first.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::list<std::string>
+InputFilenames(cl::Positional, cl::OneOrMore,
+               cl::desc("<input bitcode or IR files>"));
+
+static cl::opt<unsigned>
+MaxInsts("max-insts", cl::init(3),
+         cl::desc("Maximum number of instructions in a harvested sequence"));
+
+static cl::opt<unsigned>
+MinInsts("min-insts", cl::init(2),
+         cl::desc("Minimum number of instructions in a harvested sequence"));
+
+static cl::opt<unsigned>
+MaxCost("max-cost", cl::init(2),
+        cl::desc("Maximum number of instructions in a replacement"));
+
+static cl::opt<unsigned>
+MaxWidth("max-width", cl::init(64),
+         cl::desc("Ignore sequences using integers wider than this"));
+
+static cl::opt<unsigned>
+NumQuickTests("quick-tests", cl::init(32),
+              cl::desc("Number of inputs each candidate is first tested on"));
+
+static cl::opt<unsigned>
+NumRandomTests("random-tests", cl::init(10000),
+               cl::desc("Number of random inputs used to verify a candidate "
+                        "when exhaustive checking is too expensive"));
+
+static cl::opt<unsigned>
+ExhaustiveBits("exhaustive-bits", cl::init(16),
+               cl::desc("Verify candidates exhaustively when the inputs "
+                        "total at most this many bits"));
+
+static cl::opt<unsigned>
+MaxCandidates("max-candidates", cl::init(1000000),
+              cl::desc("Give up on a sequence after this many candidates"));
+
+static cl::opt<unsigned>
+MinCount("min-count", cl::init(1),
+         cl::desc("Only search sequences occurring at least this often"));
+
+static cl::opt<unsigned>
+TopN("top", cl::init(0),
+     cl::desc("Only report the N most frequent improvements (0 = all)"));
+
+static cl::opt<bool>
+ShowAll("show-all", cl::init(false),
+        cl::desc("Also report sequences without a cheaper replacement"));
+
+static cl::opt<unsigned>
+Seed("seed", cl::init(0x5eed), cl::desc("Seed for the random inputs"));
+
+namespace {
+
+/// A node of an expression tree. Nodes live in a vector and refer to their
+/// operands by index.
+struct Node {
+  enum KindTy { Var, Const, Op };
+
+  KindTy Kind;
+  unsigned Opcode;            // Instruction opcode, for Op.
+  CmpInst::Predicate Pred;    // For ICmp.
+  unsigned Width;             // Result width in bits.
+  unsigned VarIdx;            // For Var.
+  APInt Value;                // For Const.
+  unsigned Ops[3];
+  unsigned NumOps;
+  unsigned Cost;              // Number of Op nodes in the tree.
+
+  Node(KindTy K, unsigned W)
+      : Kind(K), Opcode(0), Pred(CmpInst::BAD_ICMP_PREDICATE), Width(W),
+        VarIdx(0), NumOps(0), Cost(0) {}
+};
+
+typedef std::vector<Node> NodeVector;
+
+/// A harvested sequence and the replacement found for it, if any.
+struct Sequence {
+  NodeVector Nodes;
+  unsigned Root;
+  SmallVector<unsigned, 4> VarWidths;
+  unsigned Count;
+
+  NodeVector Replacement;
+  unsigned ReplacementRoot;
+  bool Found;
+  bool Exhaustive;
+
+  Sequence() : Root(0), Count(0), ReplacementRoot(0), Found(false),
+               Exhaustive(false) {}
+};
+
+} // end anonymous namespace
+
+static bool isCommutative(unsigned Opcode) {
+  switch (Opcode) {
+  case Instruction::Add:
+  case Instruction::Mul:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool isSupportedOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  case Instruction::Add:  case Instruction::Sub:  case Instruction::Mul:
+  case Instruction::UDiv: case Instruction::SDiv: case Instruction::URem:
+  case Instruction::SRem: case Instruction::Shl:  case Instruction::LShr:
+  case Instruction::AShr: case Instruction::And:  case Instruction::Or:
+  case Instruction::Xor:  case Instruction::ICmp: case Instruction::Select:
+  case Instruction::ZExt: case Instruction::SExt: case Instruction::Trunc:
+    return true;
+  default:
+    return false;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Evaluation
+//===----------------------------------------------------------------------===//
+
+/// Evaluate the tree rooted at \p Idx for the variable values \p Args.
+/// Return false if the result is undefined (division by zero, signed
+/// division overflow, or an oversized shift).
+static bool evaluate(const NodeVector &Nodes, unsigned Idx,
+                     ArrayRef<APInt> Args, APInt &Result) {
+  const Node &N = Nodes[Idx];
+  switch (N.Kind) {
+  case Node::Var:
+    Result = Args[N.VarIdx];
+    return true;
+  case Node::Const:
+    Result = N.Value;
+    return true;
+  case Node::Op:
+    break;
+  }
+
+  APInt Ops[3];
+  for (unsigned i = 0; i != N.NumOps; ++i)
+    if (!evaluate(Nodes, N.Ops[i], Args, Ops[i]))
+      return false;
+  const APInt &A = Ops[0], &B = Ops[1];
+
+  switch (N.Opcode) {
+  case Instruction::Add:  Result = A + B; return true;
+  case Instruction::Sub:  Result = A - B; return true;
+  case Instruction::Mul:  Result = A * B; return true;
+  case Instruction::And:  Result = A & B; return true;
+  case Instruction::Or:   Result = A | B; return true;
+  case Instruction::Xor:  Result = A ^ B; return true;
+  case Instruction::UDiv:
+  case Instruction::URem:
+    if (!B)
+      return false;
+    Result = N.Opcode == Instruction::UDiv ? A.udiv(B) : A.urem(B);
+    return true;
+  case Instruction::SDiv:
+  case Instruction::SRem:
+    if (!B || (A.isMinSignedValue() && B.isAllOnesValue()))
+      return false;
+    Result = N.Opcode == Instruction::SDiv ? A.sdiv(B) : A.srem(B);
+    return true;
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr: {
+    if (B.uge(A.getBitWidth()))
+      return false;
+    unsigned Amt = B.getZExtValue();
+    if (N.Opcode == Instruction::Shl)
+      Result = A.shl(Amt);
+    else if (N.Opcode == Instruction::LShr)
+      Result = A.lshr(Amt);
+    else
+      Result = A.ashr(Amt);
+    return true;
+  }
+  case Instruction::ICmp: {
+    bool R;
+    switch (N.Pred) {
+    default: llvm_unreachable("Unexpected predicate");
+    case CmpInst::ICMP_EQ:  R = A.eq(B);  break;
+    case CmpInst::ICMP_NE:  R = A.ne(B);  break;
+    case CmpInst::ICMP_UGT: R = A.ugt(B); break;
+    case CmpInst::ICMP_UGE: R = A.uge(B); break;
+    case CmpInst::ICMP_ULT: R = A.ult(B); break;
+    case CmpInst::ICMP_ULE: R = A.ule(B); break;
+    case CmpInst::ICMP_SGT: R = A.sgt(B); break;
+    case CmpInst::ICMP_SGE: R = A.sge(B); break;
+    case CmpInst::ICMP_SLT: R = A.slt(B); break;
+    case CmpInst::ICMP_SLE: R = A.sle(B); break;
+    }
+    Result = APInt(1, R);
+    return true;
+  }
+  case Instruction::Select:
+    Result = A.getBoolValue() ? B : Ops[2];
+    return true;
+  case Instruction::ZExt:  Result = A.zext(N.Width);  return true;
+  case Instruction::SExt:  Result = A.sext(N.Width);  return true;
+  case Instruction::Trunc: Result = A.trunc(N.Width); return true;
+  }
+  llvm_unreachable("Unexpected opcode");
+}
+
+//===----------------------------------------------------------------------===//
+// Printing
+//===----------------------------------------------------------------------===//
+
+static StringRef getPredicateName(CmpInst::Predicate Pred) {
+  switch (Pred) {
+  default: llvm_unreachable("Unexpected predicate");
+  case CmpInst::ICMP_EQ:  return "eq";
+  case CmpInst::ICMP_NE:  return "ne";
+  case CmpInst::ICMP_UGT: return "ugt";
+  case CmpInst::ICMP_UGE: return "uge";
+  case CmpInst::ICMP_ULT: return "ult";
+  case CmpInst::ICMP_ULE: return "ule";
+  case CmpInst::ICMP_SGT: return "sgt";
+  case CmpInst::ICMP_SGE: return "sge";
+  case CmpInst::ICMP_SLT: return "slt";
+  case CmpInst::ICMP_SLE: return "sle";
+  }
+}
+
+static void print(raw_ostream &OS, const NodeVector &Nodes, unsigned Idx) {
+  const Node &N = Nodes[Idx];
+  switch (N.Kind) {
+  case Node::Var:
+    OS << '%' << N.VarIdx << ":i" << N.Width;
+    return;
+  case Node::Const:
+    if (N.Width == 1)
+      OS << (N.Value.getBoolValue() ? "true" : "false");
+    else
+      OS << N.Value.toString(10, /*Signed=*/true);
+    return;
+  case Node::Op:
+    break;
+  }
+
+  OS << '(' << Instruction::getOpcodeName(N.Opcode);
+  if (N.Opcode == Instruction::ICmp)
+    OS << ' ' << getPredicateName(N.Pred);
+  if (N.Opcode == Instruction::ZExt || N.Opcode == Instruction::SExt ||
+      N.Opcode == Instruction::Trunc || N.Opcode == Instruction::Select)
+    OS << " i" << N.Width;
+  else
+    OS << " i" << Nodes[N.Ops[0]].Width;
+  for (unsigned i = 0; i != N.NumOps; ++i) {
+    OS << (i ? ", " : " ");
+    print(OS, Nodes, N.Ops[i]);
+  }
+  OS << ')';
+}
+
+static std::string toString(const NodeVector &Nodes, unsigned Idx) {
+  std::string S;
+  raw_string_ostream OS(S);
+  print(OS, Nodes, Idx);
+  return OS.str();
+}
+
+//===----------------------------------------------------------------------===//
+// Harvesting
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Builds the canonical tree for the sequence rooted at one instruction.
+class Harvester {
+  Sequence &Seq;
+  BasicBlock *BB;
+  DenseMap<Value *, unsigned> VarIds;
+  unsigned NumInsts;
+
+  int buildOperand(Value *V);
+  int buildInst(Instruction *I);
+
+public:
+  Harvester(Sequence &S, BasicBlock *BB) : Seq(S), BB(BB), NumInsts(0) {}
+
+  bool build(Instruction *Root) {
+    int Idx = buildInst(Root);
+    if (Idx < 0)
+      return false;
+    Seq.Root = Idx;
+    return true;
+  }
+};
+} // end anonymous namespace
+
+static bool isHarvestableType(Type *Ty) {
+  return Ty->isIntegerTy() && Ty->getIntegerBitWidth() <= MaxWidth;
+}
+
+int Harvester::buildOperand(Value *V) {
+  if (!isHarvestableType(V->getType()))
+    return -1;
+
+  if (ConstantInt *CI = dyn_cast<ConstantInt>(V)) {
+    Node N(Node::Const, CI->getBitWidth());
+    N.Value = CI->getValue();
+    Seq.Nodes.push_back(N);
+    return Seq.Nodes.size() - 1;
+  }
+
+  // Fold single-use instructions of the same block into the tree.
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (I && I->getParent() == BB && I->hasOneUse() &&
+      isSupportedOpcode(I->getOpcode()) && NumInsts < MaxInsts)
+    return buildInst(I);
+
+  // Anything else is a free variable. Repeated uses share one variable.
+  auto It = VarIds.find(V);
+  unsigned VarIdx;
+  if (It != VarIds.end()) {
+    VarIdx = It->second;
+  } else {
+    VarIdx = Seq.VarWidths.size();
+    VarIds[V] = VarIdx;
+    Seq.VarWidths.push_back(V->getType()->getIntegerBitWidth());
+  }
+  Node N(Node::Var, V->getType()->getIntegerBitWidth());
+  N.VarIdx = VarIdx;
+  Seq.Nodes.push_back(N);
+  return Seq.Nodes.size() - 1;
+}
+
+int Harvester::buildInst(Instruction *I) {
+  if (!isHarvestableType(I->getType()) || !isSupportedOpcode(I->getOpcode()))
+    return -1;
+  ++NumInsts;
+
+  Node N(Node::Op, I->getType()->getIntegerBitWidth());
+  N.Opcode = I->getOpcode();
+  SmallVector<Value *, 3> Operands(I->op_begin(), I->op_end());
+
+  // Canonicalize constants to the right-hand side. Operands are visited in
+  // order, so this also fixes the variable numbering.
+  if (ICmpInst *Cmp = dyn_cast<ICmpInst>(I)) {
+    N.Pred = Cmp->getPredicate();
+    if (isa<ConstantInt>(Operands[0]) && !isa<ConstantInt>(Operands[1])) {
+      std::swap(Operands[0], Operands[1]);
+      N.Pred = Cmp->getSwappedPredicate();
+    }
+  } else if (isCommutative(N.Opcode) && isa<ConstantInt>(Operands[0]) &&
+             !isa<ConstantInt>(Operands[1])) {
+    std::swap(Operands[0], Operands[1]);
+  }
+
+  N.NumOps = Operands.size();
+  N.Cost = 1;
+  for (unsigned i = 0; i != N.NumOps; ++i) {
+    int Op = buildOperand(Operands[i]);
+    if (Op < 0)
+      return -1;
+    N.Ops[i] = Op;
+    N.Cost += Seq.Nodes[Op].Cost;
+  }
+  Seq.Nodes.push_back(N);
+  return Seq.Nodes.size() - 1;
+}
+
+/// Harvest every sequence in \p M into \p Seqs, keyed by canonical form.
+static void harvest(Module &M, StringMap<Sequence> &Seqs,
+                    unsigned &NumOccurrences) {
+  for (Function &F : M) {
+    for (BasicBlock &BB : F) {
+      for (Instruction &I : BB) {
+        if (!isSupportedOpcode(I.getOpcode()))
+          continue;
+        Sequence S;
+        Harvester H(S, &BB);
+        if (!H.build(&I))
+          continue;
+        const Node &Root = S.Nodes[S.Root];
+        if (Root.Cost < MinInsts)
+          continue;
+        std::string Key = toString(S.Nodes, S.Root);
+        Sequence &Entry = Seqs[Key];
+        if (!Entry.Count) {
+          Entry.Nodes = std::move(S.Nodes);
+          Entry.Root = S.Root;
+          Entry.VarWidths = S.VarWidths;
+        }
+        ++Entry.Count;
+        ++NumOccurrences;
+      }
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Search
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Enumerates candidate replacements for one sequence in order of increasing
+/// cost and checks each of them.
+class Searcher {
+  Sequence &Seq;
+  std::mt19937_64 &RNG;
+
+  NodeVector Pool;
+  std::map<std::pair<unsigned, unsigned>, std::vector<unsigned>> Lists;
+  SmallVector<unsigned, 4> Widths;
+  std::map<unsigned, SmallVector<APInt, 8>> Constants;
+
+  // The quick test inputs and the original results on them.
+  std::vector<SmallVector<APInt, 4>> TestArgs;
+  std::vector<APInt> TestResults;
+  unsigned NumCandidates;
+
+  void randomArgs(SmallVectorImpl<APInt> &Args);
+  void addConstant(const APInt &C);
+  bool verify(unsigned Idx, bool &Exhaustive);
+  bool check(unsigned Idx);
+  template <typename CallbackT>
+  bool forEach(unsigned Width, unsigned Cost, bool Keep, CallbackT F);
+  template <typename CallbackT>
+  bool emit(const Node &N, bool Keep, CallbackT &F);
+
+public:
+  Searcher(Sequence &S, std::mt19937_64 &RNG)
+      : Seq(S), RNG(RNG), NumCandidates(0) {}
+  void run();
+};
+} // end anonymous namespace
+
+void Searcher::randomArgs(SmallVectorImpl<APInt> &Args) {
+  Args.clear();
+  for (unsigned Width : Seq.VarWidths) {
+    // Bias towards the values where folds usually go wrong.
+    switch (RNG() % 8) {
+    case 0: Args.push_back(APInt(Width, 0)); break;
+    case 1: Args.push_back(APInt(Width, 1)); break;
+    case 2: Args.push_back(APInt::getAllOnesValue(Width)); break;
+    case 3: Args.push_back(APInt::getSignedMinValue(Width)); break;
+    case 4: Args.push_back(APInt::getSignedMaxValue(Width)); break;
+    default: Args.push_back(APInt(Width, RNG())); break;
+    }
+  }
+}
+
+void Searcher::addConstant(const APInt &C) {
+  SmallVectorImpl<APInt> &List = Constants[C.getBitWidth()];
+  for (const APInt &Existing : List)
+    if (Existing == C)
+      return;
+  List.push_back(C);
+}
+
+/// Verify candidate \p Idx on all inputs if they are small, or on many random
+/// inputs otherwise.
+bool Searcher::verify(unsigned Idx, bool &Exhaustive) {
+  unsigned TotalBits = 0;
+  for (unsigned Width : Seq.VarWidths)
+    TotalBits += Width;
+  Exhaustive = TotalBits <= ExhaustiveBits && TotalBits < 64;
+
+  SmallVector<APInt, 4> Args;
+  APInt Expected, Actual;
+  uint64_t NumTests = Exhaustive ? UINT64_C(1) << TotalBits : NumRandomTests;
+  for (uint64_t T = 0; T != NumTests; ++T) {
+    if (Exhaustive) {
+      Args.clear();
+      uint64_t Bits = T;
+      for (unsigned Width : Seq.VarWidths) {
+        Args.push_back(APInt(Width, Bits & ((UINT64_C(1) << Width) - 1)));
+        Bits >>= Width;
+      }
+    } else {
+      randomArgs(Args);
+    }
+    if (!evaluate(Seq.Nodes, Seq.Root, Args, Expected))
+      continue;
+    if (!evaluate(Pool, Idx, Args, Actual) || Actual != Expected)
+      return false;
+  }
+  return true;
+}
+
+/// Copy the tree rooted at \p Idx from \p From to the end of \p To and return
+/// the index of its root there.
+static unsigned copyTree(const NodeVector &From, unsigned Idx, NodeVector &To) {
+  Node N = From[Idx];
+  for (unsigned i = 0; i != N.NumOps; ++i)
+    N.Ops[i] = copyTree(From, N.Ops[i], To);
+  To.push_back(N);
+  return To.size() - 1;
+}
+
+/// Return true if candidate \p Idx is a verified replacement.
+bool Searcher::check(unsigned Idx) {
+  ++NumCandidates;
+  APInt Actual;
+  for (unsigned T = 0, E = TestArgs.size(); T != E; ++T)
+    if (!evaluate(Pool, Idx, TestArgs[T], Actual) || Actual != TestResults[T])
+      return false;
+
+  bool Exhaustive;
+  if (!verify(Idx, Exhaustive))
+    return false;
+  Seq.Found = true;
+  Seq.Exhaustive = Exhaustive;
+  Seq.ReplacementRoot = copyTree(Pool, Idx, Seq.Replacement);
+  return true;
+}
+
+/// Add \p N to the pool and pass it to \p F. Unless \p Keep is set, the node
+/// is removed again afterwards. Return true to stop the enumeration.
+template <typename CallbackT>
+bool Searcher::emit(const Node &N, bool Keep, CallbackT &F) {
+  Pool.push_back(N);
+  unsigned Idx = Pool.size() - 1;
+  bool Stop = F(Idx);
+  if (!Keep)
+    Pool.pop_back();
+  return Stop || NumCandidates >= MaxCandidates;
+}
+
+/// Call \p F on every expression of width \p Width with exactly \p Cost
+/// instructions. Expressions of lower cost must already be materialized.
+template <typename CallbackT>
+bool Searcher::forEach(unsigned Width, unsigned Cost, bool Keep, CallbackT F) {
+  if (Cost == 0) {
+    for (unsigned i = 0, e = Seq.VarWidths.size(); i != e; ++i) {
+      if (Seq.VarWidths[i] != Width)
+        continue;
+      Node N(Node::Var, Width);
+      N.VarIdx = i;
+      if (emit(N, Keep, F))
+        return true;
+    }
+    for (const APInt &C : Constants[Width]) {
+      Node N(Node::Const, Width);
+      N.Value = C;
+      if (emit(N, Keep, F))
+        return true;
+    }
+    return false;
+  }
+
+  auto MakeOp = [&](unsigned Opcode, unsigned W, ArrayRef<unsigned> Ops) {
+    Node N(Node::Op, W);
+    N.Opcode = Opcode;
+    N.NumOps = Ops.size();
+    N.Cost = 1;
+    for (unsigned i = 0; i != N.NumOps; ++i) {
+      N.Ops[i] = Ops[i];
+      N.Cost += Pool[Ops[i]].Cost;
+    }
+    return N;
+  };
+
+  static const unsigned BinOps[] = {
+    Instruction::Add,  Instruction::Sub,  Instruction::Mul,
+    Instruction::And,  Instruction::Or,   Instruction::Xor,
+    Instruction::Shl,  Instruction::LShr, Instruction::AShr,
+    Instruction::UDiv, Instruction::SDiv, Instruction::URem,
+    Instruction::SRem
+  };
+
+  for (unsigned C1 = 0; C1 != Cost; ++C1) {
+    unsigned C2 = Cost - 1 - C1;
+    const std::vector<unsigned> &LHSs = Lists[std::make_pair(Width, C1)];
+    const std::vector<unsigned> &RHSs = Lists[std::make_pair(Width, C2)];
+    for (unsigned A : LHSs) {
+      for (unsigned B : RHSs) {
+        // Leave constant folding to the constant folder.
+        if (Pool[A].Kind == Node::Const && Pool[B].Kind == Node::Const)
+          continue;
+        for (unsigned Opcode : BinOps) {
+          if (isCommutative(Opcode) && (C1 > C2 || (C1 == C2 && A > B)))
+            continue;
+          if (Width == 1 && Opcode != Instruction::And &&
+              Opcode != Instruction::Or && Opcode != Instruction::Xor)
+            continue;
+          if (emit(MakeOp(Opcode, Width, {A, B}), Keep, F))
+            return true;
+        }
+      }
+    }
+  }
+
+  if (Width == 1) {
+    static const CmpInst::Predicate Preds[] = {
+      CmpInst::ICMP_EQ,  CmpInst::ICMP_NE,  CmpInst::ICMP_UGT,
+      CmpInst::ICMP_UGE, CmpInst::ICMP_ULT, CmpInst::ICMP_ULE,
+      CmpInst::ICMP_SGT, CmpInst::ICMP_SGE, CmpInst::ICMP_SLT,
+      CmpInst::ICMP_SLE
+    };
+    for (unsigned OpWidth : Widths) {
+      if (OpWidth == 1)
+        continue;
+      for (unsigned C1 = 0; C1 != Cost; ++C1) {
+        unsigned C2 = Cost - 1 - C1;
+        const std::vector<unsigned> &LHSs = Lists[std::make_pair(OpWidth, C1)];
+        const std::vector<unsigned> &RHSs = Lists[std::make_pair(OpWidth, C2)];
+        for (unsigned A : LHSs) {
+          if (Pool[A].Kind == Node::Const)
+            continue;
+          for (unsigned B : RHSs) {
+            if (A == B)
+              continue;
+            for (CmpInst::Predicate Pred : Preds) {
+              Node N = MakeOp(Instruction::ICmp, 1, {A, B});
+              N.Pred = Pred;
+              if (emit(N, Keep, F))
+                return true;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (unsigned CC = 0; CC != Cost; ++CC) {
+    for (unsigned CT = 0; CC + CT != Cost; ++CT) {
+      unsigned CF = Cost - 1 - CC - CT;
+      for (unsigned Cond : Lists[std::make_pair(1u, CC)]) {
+        if (Pool[Cond].Kind == Node::Const)
+          continue;
+        for (unsigned T : Lists[std::make_pair(Width, CT)])
+          for (unsigned FV : Lists[std::make_pair(Width, CF)])
+            if (T != FV &&
+                emit(MakeOp(Instruction::Select, Width, {Cond, T, FV}), Keep,
+                     F))
+              return true;
+      }
+    }
+  }
+
+  for (unsigned SrcWidth : Widths) {
+    if (SrcWidth == Width)
+      continue;
+    for (unsigned Src : Lists[std::make_pair(SrcWidth, Cost - 1)]) {
+      if (Pool[Src].Kind == Node::Const)
+        continue;
+      if (SrcWidth < Width) {
+        if (emit(MakeOp(Instruction::ZExt, Width, {Src}), Keep, F) ||
+            emit(MakeOp(Instruction::SExt, Width, {Src}), Keep, F))
+          return true;
+      } else if (emit(MakeOp(Instruction::Trunc, Width, {Src}), Keep, F)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void Searcher::run() {
+  const Node &Root = Seq.Nodes[Seq.Root];
+
+  // Widths and constants the candidates may use.
+  Widths.push_back(Root.Width);
+  for (const Node &N : Seq.Nodes) {
+    if (std::find(Widths.begin(), Widths.end(), N.Width) == Widths.end())
+      Widths.push_back(N.Width);
+    if (N.Kind == Node::Const)
+      addConstant(N.Value);
+  }
+  for (unsigned Width : Widths) {
+    addConstant(APInt(Width, 0));
+    addConstant(APInt(Width, 1));
+    addConstant(APInt::getAllOnesValue(Width));
+  }
+
+  // Collect the quick test inputs on which the original is defined.
+  SmallVector<APInt, 4> Args;
+  APInt Result;
+  for (unsigned i = 0, Tries = 0;
+       i != NumQuickTests && Tries != 16 * NumQuickTests; ++Tries) {
+    randomArgs(Args);
+    if (!evaluate(Seq.Nodes, Seq.Root, Args, Result))
+      continue;
+    TestArgs.push_back(Args);
+    TestResults.push_back(Result);
+    ++i;
+  }
+  if (TestArgs.empty())
+    return;
+
+  unsigned Limit = std::min<unsigned>(MaxCost, Root.Cost - 1);
+  for (unsigned Cost = 0; Cost <= Limit; ++Cost) {
+    if (forEach(Root.Width, Cost, /*Keep=*/false,
+                [&](unsigned Idx) { return check(Idx); }))
+      return;
+    if (Cost == Limit)
+      break;
+    // Materialize this level for building the next one.
+    for (unsigned Width : Widths) {
+      std::vector<unsigned> Level;
+      forEach(Width, Cost, /*Keep=*/true, [&](unsigned Idx) {
+        Level.push_back(Idx);
+        return false;
+      });
+      Lists[std::make_pair(Width, Cost)] = std::move(Level);
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Driver
+//===----------------------------------------------------------------------===//
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  LLVMContext &Context = getGlobalContext();
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+  cl::ParseCommandLineOptions(argc, argv,
+                              "llvm peephole superoptimizer harness\n");
+
+  StringMap<Sequence> Seqs;
+  unsigned NumOccurrences = 0;
+  for (const std::string &Filename : InputFilenames) {
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseIRFile(Filename, Err, Context);
+    if (!M) {
+      Err.print(argv[0], errs());
+      return 1;
+    }
+    harvest(*M, Seqs, NumOccurrences);
+  }
+
+  // Most frequent first; ties are broken by the canonical form so the report
+  // is deterministic.
+  std::vector<StringMapEntry<Sequence> *> Sorted;
+  for (StringMapEntry<Sequence> &Entry : Seqs)
+    Sorted.push_back(&Entry);
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const StringMapEntry<Sequence> *A,
+               const StringMapEntry<Sequence> *B) {
+              if (A->getValue().Count != B->getValue().Count)
+                return A->getValue().Count > B->getValue().Count;
+              return A->getKey() < B->getKey();
+            });
+
+  std::mt19937_64 RNG(Seed);
+  unsigned NumFound = 0;
+  for (StringMapEntry<Sequence> *Entry : Sorted) {
+    Sequence &Seq = Entry->getValue();
+    if (Seq.Count < MinCount)
+      break;
+    if (TopN && NumFound == TopN)
+      break;
+    Searcher(Seq, RNG).run();
+    if (Seq.Found)
+      ++NumFound;
+    if (!Seq.Found && !ShowAll)
+      continue;
+
+    outs() << "; " << Seq.Count << " occurrence"
+           << (Seq.Count == 1 ? "" : "s") << ", "
+           << Seq.Nodes[Seq.Root].Cost << " instruction"
+           << (Seq.Nodes[Seq.Root].Cost == 1 ? "" : "s");
+    if (Seq.Found)
+      outs() << " -> " << Seq.Replacement[Seq.ReplacementRoot].Cost << " ("
+             << (Seq.Exhaustive ? "exhaustive" : "random") << ")";
+    outs() << '\n' << Entry->getKey() << '\n';
+    if (Seq.Found) {
+      outs() << "  => ";
+      print(outs(), Seq.Replacement, Seq.ReplacementRoot);
+      outs() << '\n';
+    }
+    outs() << '\n';
+  }
+
+  outs() << "; " << Seqs.size() << " distinct sequences, " << NumOccurrences
+         << " occurrences, " << NumFound << " with a cheaper replacement\n";
+  return 0;
+}
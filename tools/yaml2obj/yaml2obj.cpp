@@ -107,7 +107,10 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  // Objects can be described by very large documents, map them as they are
+  // parsed rather than building a copy of the whole document first.
   yaml::Input YIn(Buf.get()->getBuffer());
+  YIn.setStreaming(true);
 
   int Res = convertYAML(YIn, Out->os(), Convert);
   if (Res == 0)
@@ -265,4 +265,51 @@ TEST(CommandLineTest, HideUnrelatedOptionsMulti) {
       << "Hid default option that should be visable.";
 }
 
+TEST(CommandLineTest, OptionsAddedOnFirstUse) {
+  // An option constructed after the parser has been used is still found.
+  cl::getRegisteredOptions();
+  StackOption<int> TestOption("late-option");
+  ASSERT_EQ(1u, cl::getRegisteredOptions().count("late-option"));
+
+  // Removing an option that has not been added yet forgets it.
+  {
+    StackOption<int> Pending("pending-option");
+  }
+  ASSERT_EQ(0u, cl::getRegisteredOptions().count("pending-option"));
+}
+
+// Constructs an option when it is given a value, the way -load runs the
+// constructors of a plugin's options.
+struct LateOptionLoader {
+  static std::unique_ptr<StackOption<bool>> Loaded;
+  void operator=(const std::string &) {
+    Loaded.reset(new StackOption<bool>("late-flag"));
+  }
+};
+std::unique_ptr<StackOption<bool>> LateOptionLoader::Loaded;
+
+TEST(CommandLineTest, OptionsAddedWhileParsing) {
+  cl::opt<LateOptionLoader, false, cl::parser<std::string>> Loader(
+      "load-late-option");
+
+  // An unknown -late-flag would make the parser exit.
+  const char *args[] = {"prog", "-load-late-option=x", "-late-flag"};
+  cl::ParseCommandLineOptions(array_lengthof(args), args);
+  ASSERT_TRUE(LateOptionLoader::Loaded != nullptr);
+  EXPECT_TRUE(*LateOptionLoader::Loaded);
+
+  LateOptionLoader::Loaded.reset();
+  Loader.removeArgument();
+}
+
+TEST(CommandLineTest, PositionalOrder) {
+  StackOption<std::string> First(cl::Positional);
+  StackOption<std::string> Second(cl::Positional);
+
+  const char *args[] = { "prog", "a", "b" };
+  cl::ParseCommandLineOptions(array_lengthof(args), args);
+  EXPECT_EQ("a", First);
+  EXPECT_EQ("b", Second);
+}
+
 }  // anonymous namespace
@@ -12,10 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Compression.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
 #include "gtest/gtest.h"
+#include <string>
 
 using namespace llvm;
 
@@ -59,6 +61,66 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+void TestZlibChunkedCompression(ArrayRef<StringRef> Inputs,
+                                zlib::CompressionLevel Level, unsigned Threads,
+                                size_t BlockSize) {
+  std::string Input;
+  for (StringRef In : Inputs)
+    Input += In;
+  SmallString<32> Compressed;
+  SmallString<32> Uncompressed;
+  EXPECT_EQ(zlib::StatusOK, zlib::compressChunked(Inputs, Compressed, Level,
+                                                  Threads, BlockSize));
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::uncompress(Compressed, Uncompressed, Input.size()));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
+TEST(CompressionTest, ZlibChunked) {
+  TestZlibChunkedCompression(None, zlib::DefaultCompression, 1, 16);
+  TestZlibChunkedCompression(StringRef("hello, world!"),
+                             zlib::DefaultCompression, 1, 4);
+
+  std::string Text;
+  for (unsigned i = 0; i < 20000; ++i)
+    Text += "line " + std::to_string(i % 97) + "\n";
+  StringRef TextStr(Text);
+  StringRef Pieces[] = {TextStr.substr(0, 7), TextStr.substr(7, 50000),
+                        StringRef(), TextStr.substr(50007)};
+
+  for (unsigned Threads : {0u, 1u, 4u}) {
+    TestZlibChunkedCompression(Pieces, zlib::BestSpeedCompression, Threads,
+                               4096);
+    TestZlibChunkedCompression(Pieces, zlib::DefaultCompression, Threads,
+                               40000);
+    TestZlibChunkedCompression(Pieces, zlib::BestSizeCompression, Threads,
+                               1 << 20);
+  }
+
+  // The blocks are stitched together in order however many threads deflate
+  // them, so the output does not depend on the thread count.
+  SmallString<32> Serial;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressChunked(Pieces, Serial, zlib::DefaultCompression, 1,
+                                  4096));
+  for (unsigned Threads : {0u, 2u, 64u}) {
+    SmallString<32> Parallel;
+    EXPECT_EQ(zlib::StatusOK,
+              zlib::compressChunked(Pieces, Parallel, zlib::DefaultCompression,
+                                    Threads, 4096));
+    EXPECT_EQ(Serial, Parallel);
+  }
+
+  // A single block produces exactly what zlib::compress does.
+  SmallString<32> Chunked;
+  SmallString<32> Plain;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressChunked(Pieces, Chunked, zlib::DefaultCompression, 1,
+                                  Text.size()));
+  EXPECT_EQ(zlib::StatusOK, zlib::compress(TextStr, Plain));
+  EXPECT_EQ(Plain, Chunked);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
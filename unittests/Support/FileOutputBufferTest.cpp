@@ -11,6 +11,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
@@ -111,4 +112,83 @@ TEST(FileOutputBuffer, Test) {
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
+
+TEST(FileOutputBuffer, Stream) {
+  SmallString<128> TestDirectory;
+  ASSERT_NO_ERROR(
+      fs::createUniqueDirectory("FileOutputBuffer-stream", TestDirectory));
+
+  // Write much more than the initial size, both in small pieces and in
+  // pieces bigger than the buffer, and patch the start afterwards.
+  SmallString<128> File1(TestDirectory);
+  File1.append("/file1");
+  std::string Expected = "--------";
+  {
+    std::error_code EC;
+    raw_file_buffer_ostream OS(File1, EC, 16);
+    ASSERT_NO_ERROR(EC);
+    OS << "--------";
+    for (unsigned I = 0; I != 10000; ++I) {
+      std::string Piece = std::to_string(I) + " ";
+      OS << Piece;
+      Expected += Piece;
+    }
+    std::string Big(100000, 'x');
+    OS << Big;
+    Expected += Big;
+    EXPECT_EQ(Expected.size(), OS.tell());
+    OS.pwrite("HEADER", 6, 1);
+    Expected.replace(1, 6, "HEADER");
+    ASSERT_NO_ERROR(OS.commit());
+  }
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Contents =
+      MemoryBuffer::getFile(Twine(File1));
+  ASSERT_TRUE(bool(Contents));
+  EXPECT_EQ(Expected, (*Contents)->getBuffer());
+  ASSERT_NO_ERROR(fs::remove(File1.str()));
+
+  // Output that is not committed is discarded.
+  SmallString<128> File2(TestDirectory);
+  File2.append("/file2");
+  {
+    std::error_code EC;
+    raw_file_buffer_ostream OS(File2, EC);
+    ASSERT_NO_ERROR(EC);
+    OS << "discarded";
+  }
+  ASSERT_EQ(fs::access(Twine(File2), fs::AccessMode::Exist),
+            errc::no_such_file_or_directory);
+
+  // A file that is already open is written in place, both when it grows and
+  // when it is trimmed, and is kept once committed.
+  SmallString<128> File3;
+  int FD;
+  ASSERT_NO_ERROR(
+      fs::createUniqueFile(Twine(TestDirectory) + "/file3-%%%%%%", FD, File3));
+  {
+    std::error_code EC;
+    raw_file_buffer_ostream OS(FD, File3, EC, 4);
+    ASSERT_NO_ERROR(EC);
+    OS << "in place";
+    ASSERT_NO_ERROR(OS.commit());
+  }
+  Contents = MemoryBuffer::getFile(Twine(File3));
+  ASSERT_TRUE(bool(Contents));
+  EXPECT_EQ("in place", (*Contents)->getBuffer());
+  ASSERT_NO_ERROR(fs::remove(File3.str()));
+
+  // ... and deleted if it is not.
+  ASSERT_NO_ERROR(
+      fs::createUniqueFile(Twine(TestDirectory) + "/file4-%%%%%%", FD, File3));
+  {
+    std::error_code EC;
+    raw_file_buffer_ostream OS(FD, File3, EC);
+    ASSERT_NO_ERROR(EC);
+    OS << "discarded";
+  }
+  ASSERT_EQ(fs::access(Twine(File3), fs::AccessMode::Exist),
+            errc::no_such_file_or_directory);
+
+  ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
+}
 } // anonymous namespace
@@ -13,6 +13,7 @@
 
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -217,6 +218,54 @@ TEST_F(MemoryBufferTest, slice) {
  
 }
 
+TEST_F(MemoryBufferTest, getFilesOrSTDIN) {
+  // Read a batch of files, one of them missing, and check the results come
+  // back in order. There are more files than the reads queued ahead of the
+  // callback, and file 5 is large enough that getFile would map it.
+  std::vector<std::string> Paths;
+  std::string Large(8 * sys::Process::getPageSize(), 'x');
+  for (unsigned I = 0; I != 16; ++I) {
+    int FD;
+    SmallString<64> TestPath;
+    sys::fs::createTemporaryFile("MemoryBufferTest_Batch", "temp", FD,
+                                 TestPath);
+    raw_fd_ostream OF(FD, true);
+    OF << "file " << I;
+    if (I == 5)
+      OF << Large;
+    OF.close();
+    Paths.push_back(TestPath.str());
+  }
+  std::string Missing = Paths[3];
+  sys::fs::remove(Missing);
+
+  std::vector<size_t> Order;
+  MemoryBuffer::getFilesOrSTDIN(
+      Paths,
+      [&](size_t Index, ErrorOr<OwningBuffer> MB) {
+    Order.push_back(Index);
+    if (Index == 3) {
+      EXPECT_TRUE(bool(MB.getError()));
+      return;
+    }
+    ASSERT_FALSE(MB.getError());
+    std::string Expected = "file " + std::to_string(Index);
+    if (Index == 5)
+      Expected += Large;
+    EXPECT_EQ(Expected, MB.get()->getBuffer().str());
+    // The data has to be read by the worker, not paged in by the caller.
+    EXPECT_EQ(MemoryBuffer::MemoryBuffer_Malloc, MB.get()->getBufferKind());
+  }, 2);
+
+  ASSERT_EQ(Paths.size(), Order.size());
+  for (size_t I = 0; I != Order.size(); ++I)
+    EXPECT_EQ(I, Order[I]);
+
+  for (const std::string &Path : Paths)
+    if (Path != Missing)
+      sys::fs::remove(Path);
+}
+
 
 
 }
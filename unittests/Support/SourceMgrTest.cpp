@@ -97,6 +97,38 @@ TEST_F(SourceMgrTest, LocationAtNewline) {
             Output);
 }
 
+TEST_F(SourceMgrTest, LineAndColumnOutOfOrder) {
+  setMainBuffer("aaa\nbb\n\nc", "file.in");
+
+  EXPECT_EQ(std::make_pair(4u, 1u), SM.getLineAndColumn(getLoc(8)));
+  EXPECT_EQ(std::make_pair(2u, 2u), SM.getLineAndColumn(getLoc(5)));
+  EXPECT_EQ(std::make_pair(1u, 1u), SM.getLineAndColumn(getLoc(0)));
+  EXPECT_EQ(std::make_pair(3u, 1u), SM.getLineAndColumn(getLoc(7)));
+  EXPECT_EQ(std::make_pair(1u, 4u), SM.getLineAndColumn(getLoc(3)));
+  EXPECT_EQ(std::make_pair(4u, 2u), SM.getLineAndColumn(getLoc(9)));
+}
+
+TEST_F(SourceMgrTest, ManyLineLookups) {
+  // Look up many locations in a big buffer in no particular order. This used
+  // to rescan the buffer from the start for every backwards lookup.
+  const unsigned NumLines = 100000;
+  std::string Text;
+  std::vector<unsigned> LineStarts;
+  for (unsigned I = 0; I != NumLines; ++I) {
+    LineStarts.push_back(Text.size());
+    Text += "line " + std::to_string(I) + "\n";
+  }
+  setMainBuffer(Text, "file.in");
+
+  unsigned Seed = 1;
+  for (unsigned I = 0; I != 10000; ++I) {
+    Seed = Seed * 1103515245 + 12345;
+    unsigned Line = Seed % NumLines;
+    EXPECT_EQ(std::make_pair(Line + 1, 3u),
+              SM.getLineAndColumn(getLoc(LineStarts[Line] + 2)));
+  }
+}
+
 TEST_F(SourceMgrTest, BasicRange) {
   setMainBuffer("aaa bbb\nccc ddd\n", "file.in");
   printMessage(getLoc(4), SourceMgr::DK_Error, "message", getRange(4, 3), None);
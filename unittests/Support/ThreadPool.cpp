@@ -0,0 +1,63 @@
+//===- unittests/Support/ThreadPool.cpp - ThreadPool.h tests --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ThreadPoolTest, AsyncBarrier) {
+  std::atomic_int checked_in{0};
+
+  ThreadPool Pool;
+  for (size_t i = 0; i < 5; ++i) {
+    Pool.async([&checked_in, i] { ++checked_in; });
+  }
+  Pool.wait();
+  ASSERT_EQ(5, checked_in);
+}
+
+TEST(ThreadPoolTest, AsyncBarrierArgs) {
+  std::atomic_int checked_in{0};
+
+  ThreadPool Pool(2);
+  for (size_t i = 0; i < 5; ++i) {
+    Pool.async([](std::atomic_int *Counter, int Amount) { *Counter += Amount; },
+               &checked_in, (int)i);
+  }
+  Pool.wait();
+  ASSERT_EQ(10, checked_in);
+}
+
+TEST(ThreadPoolTest, GetFuture) {
+  ThreadPool Pool(2);
+  std::atomic_int i{0};
+  auto Future = Pool.async([&i] { ++i; });
+  Future.get();
+  ASSERT_EQ(1, i);
+}
+
+TEST(ThreadPoolTest, PoolDestruction) {
+  // Test that we are waiting on destruction
+  std::atomic_int checked_in{0};
+  {
+    ThreadPool Pool;
+    for (size_t i = 0; i < 5; ++i) {
+      Pool.async([&checked_in, i] { ++checked_in; });
+    }
+  }
+  ASSERT_EQ(5, checked_in);
+}
+
+} // end anonymous namespace
@@ -2194,3 +2194,95 @@ TEST(YAMLIO, TestWrapFlow) {
     out.clear();
   }
 }
+
+//===----------------------------------------------------------------------===//
+//  Test streaming input
+//===----------------------------------------------------------------------===//
+
+//
+// Test reading a sequence of mappings, with keys both in and out of the order
+// the traits map them.
+//
+TEST(YAMLIO, TestStreamingContainerSequenceMapRead) {
+  FooBarContainer cont;
+  Input yin("---\nfbs:\n - foo: 3\n   bar: 5\n - bar: 9\n   foo: 7\n"
+            " - { foo: 1, bar: 2 }\n...\n");
+  yin.setStreaming(true);
+  yin >> cont;
+
+  EXPECT_FALSE(yin.error());
+  ASSERT_EQ(cont.fbs.size(), 3UL);
+  EXPECT_EQ(cont.fbs[0].foo, 3);
+  EXPECT_EQ(cont.fbs[0].bar, 5);
+  EXPECT_EQ(cont.fbs[1].foo, 7);
+  EXPECT_EQ(cont.fbs[1].bar, 9);
+  EXPECT_EQ(cont.fbs[2].foo, 1);
+  EXPECT_EQ(cont.fbs[2].bar, 2);
+}
+
+TEST(YAMLIO, TestStreamingUnknownKey) {
+  FooBarSequence seq;
+  Input yin("---\n - foo: 3\n   bar: 5\n - foo: 7\n   baz: 8\n   bar: 9\n...\n",
+            nullptr, suppressErrorMessages);
+  yin.setStreaming(true);
+  yin >> seq;
+  EXPECT_TRUE(!!yin.error());
+}
+
+TEST(YAMLIO, TestStreamingMissingKey) {
+  FooBarSequence seq;
+  Input yin("---\n - foo: 3\n   bar: 5\n - foo: 7\n...\n", nullptr,
+            suppressErrorMessages);
+  yin.setStreaming(true);
+  yin >> seq;
+  EXPECT_TRUE(!!yin.error());
+}
+
+TEST(YAMLIO, TestStreamingFlagsRead) {
+  FlagsMap map;
+  Input yin("---\n"
+            "f2:  [ round, flat ]\n"
+            "f1:  [ big ]\n"
+            "f3:\n"
+            "  - pointy\n"
+            "...\n");
+  yin.setStreaming(true);
+  yin >> map;
+
+  EXPECT_FALSE(yin.error());
+  EXPECT_EQ(flagBig,              map.f1);
+  EXPECT_EQ(flagRound|flagFlat,   map.f2);
+  EXPECT_EQ(flagPointy,           map.f3);
+  EXPECT_EQ(flagRound,            map.f4);
+}
+
+TEST(YAMLIO, TestStreamingDocListWriteAndRead) {
+  std::string intermediate;
+  {
+    std::vector<FooBarMap> docList;
+    for (int i = 0; i != 10; ++i) {
+      FooBarMap doc;
+      doc.foo = i;
+      doc.bar = -i;
+      docList.push_back(doc);
+    }
+
+    llvm::raw_string_ostream ostr(intermediate);
+    Output yout(ostr);
+    yout << docList;
+  }
+
+  {
+    Input yin(intermediate);
+    yin.setStreaming(true);
+    std::vector<FooBarMap> docList2;
+    yin >> docList2;
+
+    EXPECT_FALSE(yin.error());
+    ASSERT_EQ(docList2.size(), 10UL);
+    for (int i = 0; i != 10; ++i) {
+      EXPECT_EQ(docList2[i].foo, i);
+      EXPECT_EQ(docList2[i].bar, -i);
+    }
+  }
+}
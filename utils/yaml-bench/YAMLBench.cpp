@@ -8,7 +8,8 @@
 //===----------------------------------------------------------------------===//
 //
 // This program executes the YAMLParser on differently sized YAML texts and
-// outputs the run time.
+// outputs the run time. With -io it instead compares the throughput of
+// mapping the texts with YAML I/O, with and without streaming.
 //
 //===----------------------------------------------------------------------===//
 
@@ -16,11 +17,13 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/YAMLTraits.h"
 #include "llvm/Support/raw_ostream.h"
 #include <system_error>
 
@@ -48,6 +51,13 @@ static cl::opt<bool>
         , cl::init(false)
         );
 
+static cl::opt<bool>
+  IOThroughput( "io"
+              , cl::desc("Compare mapping the benchmark texts with YAML I/O, "
+                         "with and without streaming.")
+              , cl::init(false)
+              );
+
 static cl::opt<unsigned>
   MemoryLimitMB("memory-limit", cl::desc(
                   "Do not use more megabytes of memory"),
@@ -172,6 +182,55 @@ static void benchmark( llvm::TimerGroup &Group
   Parsing.stopTimer();
 }
 
+namespace {
+/// \brief One of the mappings in the text created by createJSONText.
+struct BenchEntry {
+  StringRef Key1;
+  StringRef Key2;
+  StringRef Key3;
+};
+}
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(BenchEntry)
+
+namespace llvm {
+namespace yaml {
+template <> struct MappingTraits<BenchEntry> {
+  static void mapping(IO &IO, BenchEntry &Entry) {
+    IO.mapRequired("key1", Entry.Key1);
+    IO.mapRequired("key2", Entry.Key2);
+    IO.mapRequired("key3", Entry.Key3);
+  }
+};
+}
+}
+
+/// \brief Map JSONText with YAML I/O and print the throughput and how much
+/// memory is held once the text has been mapped.
+static void benchmarkIO(llvm::StringRef Name, llvm::StringRef JSONText,
+                        bool Streaming) {
+  size_t MallocBefore = sys::Process::GetMallocUsage();
+  TimeRecord Start = TimeRecord::getCurrentTime(true);
+  std::vector<BenchEntry> Entries;
+  yaml::Input YIn(JSONText);
+  YIn.setStreaming(Streaming);
+  YIn >> Entries;
+  TimeRecord End = TimeRecord::getCurrentTime(false);
+  size_t MallocAfter = sys::Process::GetMallocUsage();
+
+  double MB = JSONText.size() / (1024.0 * 1024.0);
+  double Seconds = End.getWallTime() - Start.getWallTime();
+  outs() << format("%-14s %-9s %10.1f MB/s %10.1f MB held\n",
+                   Name.str().c_str(), Streaming ? "streaming" : "tree",
+                   YIn.error() ? 0.0 : MB / Seconds,
+                   ((double)MallocAfter - MallocBefore) / (1024.0 * 1024.0));
+}
+
+static void benchmarkIO(llvm::StringRef Name, llvm::StringRef JSONText) {
+  benchmarkIO(Name, JSONText, false);
+  benchmarkIO(Name, JSONText, true);
+}
+
 static std::string createJSONText(size_t MemoryMB, unsigned ValueSize) {
   std::string JSONText;
   llvm::raw_string_ostream Stream(JSONText);
@@ -217,7 +276,13 @@ int main(int argc, char **argv) {
     }
   }
 
-  if (Verify) {
+  if (IOThroughput) {
+    outs() << "; " << MemoryLimitMB << " MB texts, heap held after mapping "
+           << "includes the mapped entries\n";
+    benchmarkIO("Small Values", createJSONText(MemoryLimitMB, 5));
+    benchmarkIO("Medium Values", createJSONText(MemoryLimitMB, 500));
+    benchmarkIO("Large Values", createJSONText(MemoryLimitMB, 50000));
+  } else if (Verify) {
     llvm::TimerGroup Group("YAML parser benchmark");
     benchmark(Group, "Fast", createJSONText(10, 500));
   } else if (!DumpCanonical && !DumpTokens) {